@@ -0,0 +1,143 @@
+#include "asyncimageloader.h"
+#include "coverimagecache.h"
+#include <QDebug>
+#include <QMetaObject>
+#include <QPointer>
+#include <QRunnable>
+#include <QThread>
+
+namespace {
+
+class ImageLoadTask : public QRunnable
+{
+public:
+    ImageLoadTask(const std::function<void(const QImage &)> &onFinished, const QString &path, const QSize &size,
+                  Qt::AspectRatioMode mode, const QSharedPointer<QAtomicInt> &cancelFlag)
+        : m_onFinished(onFinished), m_path(path), m_size(size), m_mode(mode), m_cancelFlag(cancelFlag)
+    {
+    }
+
+    void run() override
+    {
+        // Скасовані запити, що ще чекали в черзі, завершуються без декодування
+        if (m_cancelFlag->loadRelaxed()) {
+            m_onFinished(QImage());
+            return;
+        }
+        m_onFinished(CoverImageCache::loadScaledImage(m_path, m_size, m_mode));
+    }
+
+private:
+    std::function<void(const QImage &)> m_onFinished;
+    QString m_path;
+    QSize m_size;
+    Qt::AspectRatioMode m_mode;
+    QSharedPointer<QAtomicInt> m_cancelFlag;
+};
+
+} // namespace
+
+AsyncImageLoader *AsyncImageLoader::instance()
+{
+    static AsyncImageLoader *loader = new AsyncImageLoader();
+    return loader;
+}
+
+AsyncImageLoader::AsyncImageLoader(QObject *parent)
+    : QObject(parent)
+{
+    m_threadPool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() - 1));
+}
+
+QString AsyncImageLoader::requestKey(const QString &path, const QSize &size, Qt::AspectRatioMode mode)
+{
+    return QString("%1|%2x%3|%4").arg(path).arg(size.width()).arg(size.height()).arg(static_cast<int>(mode));
+}
+
+bool AsyncImageLoader::requestPixmap(const QString &path, const QSize &size, Qt::AspectRatioMode mode, QPixmap *pixmap)
+{
+    if (path.isEmpty() || !size.isValid()) {
+        return false;
+    }
+    if (CoverImageCache::instance().findInMemory(path, size, mode, pixmap)) {
+        return true;
+    }
+
+    const QString key = requestKey(path, size, mode);
+    if (m_pending.contains(key) || m_failedKeys.contains(key)) {
+        return false;
+    }
+
+    QSharedPointer<QAtomicInt> cancelFlag(new QAtomicInt(0));
+    m_pending.insert(key, cancelFlag);
+
+    auto onFinished = [this, key, path, size, mode, cancelFlag](const QImage &image) {
+        QMetaObject::invokeMethod(this, [this, key, path, size, mode, cancelFlag, image]() {
+            finishRequest(key, path, size, mode, cancelFlag, image);
+        }, Qt::QueuedConnection);
+    };
+    m_threadPool.start(new ImageLoadTask(onFinished, path, size, mode, cancelFlag));
+    return false;
+}
+
+void AsyncImageLoader::loadPixmap(QObject *receiver, const QString &path, const QSize &size, Qt::AspectRatioMode mode,
+                                  const std::function<void(const QPixmap &)> &onReady)
+{
+    QPixmap pixmap;
+    if (requestPixmap(path, size, mode, &pixmap)) {
+        onReady(pixmap);
+        return;
+    }
+    if (!isPending(path, size, mode)) {
+        return; // Порожній шлях або файл, який раніше не вдалося прочитати
+    }
+
+    // Одноразове підключення: від'єднується після відповіді на свій запит
+    QSharedPointer<QMetaObject::Connection> connection(new QMetaObject::Connection);
+    *connection = connect(this, &AsyncImageLoader::pixmapReady, receiver,
+                          [connection, path, size, mode, onReady](const QString &readyPath, const QSize &readySize, int readyMode, const QPixmap &readyPixmap) {
+        if (readyPath != path || readySize != size || readyMode != static_cast<int>(mode)) {
+            return;
+        }
+        QObject::disconnect(*connection);
+        if (!readyPixmap.isNull()) {
+            onReady(readyPixmap);
+        }
+    });
+}
+
+void AsyncImageLoader::cancel(const QString &path, const QSize &size, Qt::AspectRatioMode mode)
+{
+    auto it = m_pending.find(requestKey(path, size, mode));
+    if (it == m_pending.end()) {
+        return;
+    }
+    it.value()->storeRelaxed(1);
+    m_pending.erase(it);
+}
+
+bool AsyncImageLoader::isPending(const QString &path, const QSize &size, Qt::AspectRatioMode mode) const
+{
+    return m_pending.contains(requestKey(path, size, mode));
+}
+
+void AsyncImageLoader::finishRequest(const QString &key, const QString &path, const QSize &size, Qt::AspectRatioMode mode,
+                                     const QSharedPointer<QAtomicInt> &cancelFlag, const QImage &image)
+{
+    if (cancelFlag->loadRelaxed()) {
+        return; // Запит скасовано; новий запит (якщо був) має власний прапорець
+    }
+    if (m_pending.value(key) == cancelFlag) {
+        m_pending.remove(key);
+    }
+
+    QPixmap pixmap;
+    if (image.isNull()) {
+        qWarning() << "AsyncImageLoader: не вдалося завантажити зображення" << path;
+        m_failedKeys.insert(key);
+    } else {
+        pixmap = QPixmap::fromImage(image);
+        CoverImageCache::instance().insertInMemory(path, size, mode, pixmap);
+    }
+    emit pixmapReady(path, size, static_cast<int>(mode), pixmap);
+}
@@ -0,0 +1,53 @@
+#ifndef ASYNCIMAGELOADER_H
+#define ASYNCIMAGELOADER_H
+
+#include <QObject>
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
+#include <QSet>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QSize>
+#include <QThreadPool>
+#include <functional>
+
+// Фонове завантаження обкладинок: декодування (QImageReader зі setScaledSize) виконується
+// у пулі потоків, а готове зображення потрапляє в CoverImageCache і повідомляється сигналом
+// pixmapReady у GUI-потоці. Поки зображення завантажується, картки показують заглушку.
+// Запити, що стали непотрібними (картка прокручена за межі видимої області), можна скасувати.
+class AsyncImageLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    static AsyncImageLoader *instance();
+
+    // true — зображення вже в кеші пам'яті (pixmap заповнено); інакше ставить запит у чергу
+    // (повторні запити того самого зображення не дублюються) і повертає false.
+    bool requestPixmap(const QString &path, const QSize &size, Qt::AspectRatioMode mode, QPixmap *pixmap);
+    // Викликає onReady одразу (якщо зображення в кеші) або після фонового завантаження.
+    // Якщо receiver знищено раніше, колбек не викликається. При помилці читання колбек не викликається.
+    void loadPixmap(QObject *receiver, const QString &path, const QSize &size, Qt::AspectRatioMode mode,
+                    const std::function<void(const QPixmap &)> &onReady);
+
+    void cancel(const QString &path, const QSize &size, Qt::AspectRatioMode mode);
+    bool isPending(const QString &path, const QSize &size, Qt::AspectRatioMode mode) const;
+
+signals:
+    // pixmap порожній, якщо файл не вдалося прочитати
+    void pixmapReady(const QString &path, const QSize &size, int mode, const QPixmap &pixmap);
+
+private:
+    explicit AsyncImageLoader(QObject *parent = nullptr);
+
+    static QString requestKey(const QString &path, const QSize &size, Qt::AspectRatioMode mode);
+    void finishRequest(const QString &key, const QString &path, const QSize &size, Qt::AspectRatioMode mode,
+                       const QSharedPointer<QAtomicInt> &cancelFlag, const QImage &image);
+
+    QThreadPool m_threadPool;
+    QHash<QString, QSharedPointer<QAtomicInt>> m_pending; // ключ запиту -> прапорець скасування
+    QSet<QString> m_failedKeys; // Файли, які не вдалося прочитати, не запитуються повторно
+};
+
+#endif // ASYNCIMAGELOADER_H
@@ -0,0 +1,195 @@
+#include "bookcarddelegate.h"
+#include <QMouseEvent>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QAbstractItemView>
+#include "asyncimageloader.h"
+
+BookCardDelegate::BookCardDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+QRect BookCardDelegate::cardRect(const QRect &itemRect) const
+{
+    // Картка має фіксований розмір і центрується в комірці view
+    QRect card(QPoint(0, 0), m_cardSize);
+    card.moveCenter(itemRect.center());
+    return card;
+}
+
+QRect BookCardDelegate::coverRect(const QRect &card) const
+{
+    return QRect(card.left() + m_padding, card.top() + m_padding, card.width() - m_padding * 2, m_coverHeight);
+}
+
+QRect BookCardDelegate::buttonRect(const QRect &card) const
+{
+    return QRect(card.left() + m_padding, card.bottom() - m_padding - m_buttonHeight + 1, card.width() - m_padding * 2, m_buttonHeight);
+}
+
+void BookCardDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    const QString title = index.data(BookGridRoles::TitleRole).toString();
+    const QString authors = index.data(BookGridRoles::AuthorsRole).toString();
+    const QString coverPath = index.data(BookGridRoles::CoverImagePathRole).toString();
+    const double price = index.data(BookGridRoles::PriceRole).toDouble();
+    const double averageRating = index.data(BookGridRoles::AverageRatingRole).toDouble();
+    const int ratingCount = index.data(BookGridRoles::RatingCountRole).toInt();
+    const bool isHovered = option.state & QStyle::State_MouseOver;
+
+    const QRect card = cardRect(option.rect);
+    QPainterPath cardPath;
+    cardPath.addRoundedRect(QRectF(card).adjusted(0.5, 0.5, -0.5, -0.5), 8, 8);
+    painter->fillPath(cardPath, Qt::white);
+    painter->setPen(QPen(isHovered ? QColor("#0078d4") : QColor("#dcdcdc"), 1));
+    painter->drawPath(cardPath);
+
+    // Обкладинка
+    const QRect cover = coverRect(card);
+    // Декодування виконується у фоні: поки обкладинки немає в кеші, малюється заглушка,
+    // а після pixmapReady view перемальовує картку вже із зображенням
+    QPixmap pixmap;
+    if (!AsyncImageLoader::instance()->requestPixmap(coverPath, cover.size(), Qt::KeepAspectRatio, &pixmap)
+        && AsyncImageLoader::instance()->isPending(coverPath, cover.size(), Qt::KeepAspectRatio)) {
+        m_pendingCovers.insert(coverPath, QPersistentModelIndex(index));
+    }
+    if (pixmap.isNull()) {
+        QPainterPath placeholderPath;
+        placeholderPath.addRoundedRect(QRectF(cover), 4, 4);
+        painter->fillPath(placeholderPath, QColor("#e0e0e0"));
+        painter->setPen(QColor("#555555"));
+        painter->drawText(cover, Qt::AlignCenter, tr("Немає\nобкладинки"));
+    } else {
+        painter->drawPixmap(cover.left() + (cover.width() - pixmap.width()) / 2,
+                            cover.top() + (cover.height() - pixmap.height()) / 2,
+                            pixmap);
+    }
+
+    int y = cover.bottom() + 1 + 8;
+    const int textLeft = card.left() + m_padding;
+    const int textWidth = card.width() - m_padding * 2;
+
+    // Назва (до двох рядків)
+    QFont titleFont = option.font;
+    titleFont.setBold(true);
+    titleFont.setPointSize(11);
+    painter->setFont(titleFont);
+    painter->setPen(Qt::black);
+    const QFontMetrics titleMetrics(titleFont);
+    const QRect titleRect(textLeft, y, textWidth, titleMetrics.lineSpacing() * 2);
+    QString titleText = title;
+    if (titleMetrics.boundingRect(titleRect, Qt::AlignHCenter | Qt::TextWordWrap, titleText).height() > titleRect.height()) {
+        titleText = titleMetrics.elidedText(title, Qt::ElideRight, textWidth * 2 - titleMetrics.averageCharWidth() * 2);
+    }
+    painter->drawText(titleRect, Qt::AlignHCenter | Qt::AlignTop | Qt::TextWordWrap, titleText);
+    y = titleRect.bottom() + 1 + 2;
+
+    // Автори
+    QFont authorFont = option.font;
+    authorFont.setPointSize(9);
+    painter->setFont(authorFont);
+    painter->setPen(QColor("#555555"));
+    const QFontMetrics authorMetrics(authorFont);
+    const QString authorText = authors.isEmpty() ? tr("Невідомий автор") : authors;
+    painter->drawText(QRect(textLeft, y, textWidth, authorMetrics.lineSpacing()), Qt::AlignHCenter | Qt::AlignVCenter,
+                      authorMetrics.elidedText(authorText, Qt::ElideRight, textWidth));
+    y += authorMetrics.lineSpacing() + 5;
+
+    // Ціна
+    QFont priceFont = option.font;
+    priceFont.setBold(true);
+    priceFont.setPointSize(10);
+    painter->setFont(priceFont);
+    painter->setPen(QColor("#007bff"));
+    const QRect priceRect(textLeft, y, textWidth, QFontMetrics(priceFont).lineSpacing());
+    const QString priceText = QString::number(price, 'f', 2) + tr(" грн");
+    if (ratingCount > 0) {
+        // Ціна ліворуч, середня оцінка праворуч в одному рядку
+        painter->drawText(priceRect, Qt::AlignLeft | Qt::AlignVCenter, priceText);
+        QFont ratingFont = option.font;
+        ratingFont.setPointSize(9);
+        painter->setFont(ratingFont);
+        painter->setPen(QColor("#f5a623"));
+        painter->drawText(priceRect, Qt::AlignRight | Qt::AlignVCenter,
+                          QString("★ %1 (%2)").arg(averageRating, 0, 'f', 1).arg(ratingCount));
+    } else {
+        painter->drawText(priceRect, Qt::AlignHCenter | Qt::AlignVCenter, priceText);
+    }
+
+    // Кнопка "Додати до кошика"
+    const QRect button = buttonRect(card);
+    QPainterPath buttonPath;
+    buttonPath.addRoundedRect(QRectF(button), 8, 8);
+    painter->fillPath(buttonPath, isHovered ? QColor("#218838") : QColor("#28a745"));
+    QFont buttonFont = option.font;
+    buttonFont.setPointSize(9);
+    painter->setFont(buttonFont);
+    painter->setPen(Qt::white);
+    painter->drawText(button, Qt::AlignCenter, tr("🛒 Додати"));
+
+    painter->restore();
+}
+
+void BookCardDelegate::cancelInvisibleLoads(QAbstractItemView *view)
+{
+    if (!view || m_pendingCovers.isEmpty()) {
+        return;
+    }
+    const QRect viewportRect = view->viewport()->rect();
+    const QSize coverSize = coverRect(QRect(QPoint(0, 0), m_cardSize)).size();
+    AsyncImageLoader *loader = AsyncImageLoader::instance();
+
+    for (auto it = m_pendingCovers.begin(); it != m_pendingCovers.end();) {
+        if (!loader->isPending(it.key(), coverSize, Qt::KeepAspectRatio)) {
+            it = m_pendingCovers.erase(it); // Уже завантажено
+            continue;
+        }
+        const QModelIndex index = it.value();
+        if (!index.isValid() || !view->visualRect(index).intersects(viewportRect)) {
+            loader->cancel(it.key(), coverSize, Qt::KeepAspectRatio);
+            it = m_pendingCovers.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
+void BookCardDelegate::cancelAllLoads()
+{
+    const QSize coverSize = coverRect(QRect(QPoint(0, 0), m_cardSize)).size();
+    for (auto it = m_pendingCovers.cbegin(); it != m_pendingCovers.cend(); ++it) {
+        AsyncImageLoader::instance()->cancel(it.key(), coverSize, Qt::KeepAspectRatio);
+    }
+    m_pendingCovers.clear();
+}
+
+QSize BookCardDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(option);
+    Q_UNUSED(index);
+    return m_cardSize;
+}
+
+bool BookCardDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() == QEvent::MouseButtonRelease) {
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+        if (mouseEvent->button() == Qt::LeftButton) {
+            const QRect card = cardRect(option.rect);
+            const int bookId = index.data(BookGridRoles::BookIdRole).toInt();
+            if (buttonRect(card).contains(mouseEvent->pos())) {
+                emit addToCartClicked(bookId);
+                return true;
+            }
+            if (card.contains(mouseEvent->pos())) {
+                emit bookClicked(bookId);
+                return true;
+            }
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
@@ -0,0 +1,52 @@
+#ifndef BOOKCARDDELEGATE_H
+#define BOOKCARDDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QPainter>
+#include <QStyleOptionViewItem>
+#include <QModelIndex>
+#include <QSize>
+#include <QHash>
+#include <QPersistentModelIndex>
+#include "bookgridmodel.h"
+
+class QAbstractItemView;
+
+// Малює картку книги (обкладинка, назва, автори, ціна, кнопка "Додати") для BookGridModel.
+// Замість окремого QFrame з дочірніми віджетами на кожну книгу, QListView малює лише видимі картки.
+class BookCardDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit BookCardDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    // Скасовує фонове завантаження обкладинок карток, що вийшли за межі видимої області
+    void cancelInvisibleLoads(QAbstractItemView *view);
+    void cancelAllLoads();
+
+signals:
+    void bookClicked(int bookId);
+    void addToCartClicked(int bookId);
+
+protected:
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+private:
+    QRect cardRect(const QRect &itemRect) const;
+    QRect coverRect(const QRect &card) const;
+    QRect buttonRect(const QRect &card) const;
+
+    QSize m_cardSize = QSize(200, 340);
+    int m_padding = 10;
+    int m_coverHeight = 200;
+    int m_buttonHeight = 32;
+
+    // Обкладинки, що зараз завантажуються у фоні (шлях -> рядок моделі)
+    mutable QHash<QString, QPersistentModelIndex> m_pendingCovers;
+};
+
+#endif // BOOKCARDDELEGATE_H
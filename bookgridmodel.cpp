@@ -0,0 +1,170 @@
+#include "bookgridmodel.h"
+#include "database.h"
+#include <QDebug>
+
+BookGridModel::BookGridModel(DatabaseManager *dbManager, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_dbManager(dbManager)
+{
+}
+
+int BookGridModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_snapshot ? m_snapshotRows.size() : m_books.size();
+}
+
+QVariant BookGridModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rowCount()) {
+        return QVariant();
+    }
+
+    const BookDisplayInfo book = bookAt(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case BookGridRoles::TitleRole:
+        return book.title;
+    case Qt::ToolTipRole:
+        return book.authors.isEmpty() ? book.title : book.title + "\n" + book.authors;
+    case BookGridRoles::BookIdRole:
+        return book.bookId;
+    case BookGridRoles::AuthorsRole:
+        return book.authors;
+    case BookGridRoles::PriceRole:
+        return book.price;
+    case BookGridRoles::CoverImagePathRole:
+        return book.coverImagePath;
+    case BookGridRoles::StockQuantityRole:
+        return book.stockQuantity;
+    case BookGridRoles::GenreRole:
+        return book.genre;
+    case BookGridRoles::AverageRatingRole:
+        return book.averageRating();
+    case BookGridRoles::RatingCountRole:
+        return book.ratingCount;
+    default:
+        return QVariant();
+    }
+}
+
+bool BookGridModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return false;
+    return m_hasMore && !m_loading;
+}
+
+void BookGridModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid()) return;
+    requestNextPage();
+}
+
+void BookGridModel::setFilterCriteria(const BookFilterCriteria &criteria)
+{
+    if (m_snapshot) {
+        m_criteria = criteria;
+        applySnapshotFilter();
+        return;
+    }
+
+    beginResetModel();
+    m_books.clear();
+    m_criteria = criteria;
+    m_cursor = BookPageCursor();
+    m_hasMore = true;
+    m_loading = false;
+    ++m_generation;
+    endResetModel();
+
+    requestNextPage();
+}
+
+void BookGridModel::setPageSize(int pageSize)
+{
+    m_pageSize = qMax(1, pageSize);
+}
+
+void BookGridModel::setCatalogSnapshot(const QSharedPointer<const CatalogSnapshot> &snapshot)
+{
+    m_snapshot = snapshot;
+    m_snapshotRows.clear();
+    setFilterCriteria(m_criteria);
+}
+
+void BookGridModel::updateCatalogSnapshot(const QSharedPointer<const CatalogSnapshot> &snapshot)
+{
+    if (!m_snapshot || !snapshot) {
+        setCatalogSnapshot(snapshot);
+        return;
+    }
+    const QVector<int> rows = snapshot->filter(m_criteria);
+    if (rows != m_snapshotRows) {
+        m_snapshot = snapshot;
+        applySnapshotFilter();
+        return;
+    }
+    m_snapshot = snapshot;
+    if (!m_snapshotRows.isEmpty()) {
+        emit dataChanged(index(0, 0), index(m_snapshotRows.size() - 1, 0));
+    }
+}
+
+void BookGridModel::applySnapshotFilter()
+{
+    beginResetModel();
+    m_books.clear();
+    m_snapshotRows = m_snapshot->filter(m_criteria);
+    m_cursor = BookPageCursor();
+    m_hasMore = false;
+    m_loading = false;
+    ++m_generation; // Сторінки, запитані до перемикання на знімок, відкидаються
+    endResetModel();
+
+    emit firstPageLoaded(m_snapshotRows.size());
+    emit pageLoaded(m_snapshotRows.size(), false);
+}
+
+BookDisplayInfo BookGridModel::bookAt(int row) const
+{
+    if (m_snapshot) {
+        return m_snapshot->bookAt(m_snapshotRows.value(row, -1));
+    }
+    if (row < 0 || row >= m_books.size()) {
+        return BookDisplayInfo();
+    }
+    return m_books.at(row);
+}
+
+void BookGridModel::requestNextPage()
+{
+    if (!m_dbManager || !m_hasMore || m_loading) {
+        return;
+    }
+
+    m_loading = true;
+    const int generation = m_generation;
+    const bool firstPage = m_cursor.isStart();
+
+    m_dbManager->getBooksPageAsync(m_criteria, m_cursor, m_pageSize, this, [this, generation, firstPage](const BookPage &page) {
+        if (generation != m_generation) {
+            qDebug() << "BookGridModel: discarding stale page for generation" << generation;
+            return;
+        }
+        m_loading = false;
+        m_cursor = page.nextCursor;
+        m_hasMore = page.hasMore;
+
+        if (!page.books.isEmpty()) {
+            const int first = m_books.size();
+            beginInsertRows(QModelIndex(), first, first + page.books.size() - 1);
+            m_books.append(page.books);
+            endInsertRows();
+        }
+
+        if (firstPage) {
+            emit firstPageLoaded(page.books.size());
+        }
+        emit pageLoaded(m_books.size(), m_hasMore);
+    });
+}
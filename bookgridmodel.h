@@ -0,0 +1,77 @@
+#ifndef BOOKGRIDMODEL_H
+#define BOOKGRIDMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QSharedPointer>
+#include <QVector>
+#include "datatypes.h"
+#include "catalogsnapshot.h"
+
+class DatabaseManager;
+
+namespace BookGridRoles {
+    const int BookIdRole = Qt::UserRole + 1;
+    const int TitleRole = Qt::UserRole + 2;
+    const int AuthorsRole = Qt::UserRole + 3;
+    const int PriceRole = Qt::UserRole + 4;
+    const int CoverImagePathRole = Qt::UserRole + 5;
+    const int StockQuantityRole = Qt::UserRole + 6;
+    const int GenreRole = Qt::UserRole + 7;
+    const int AverageRatingRole = Qt::UserRole + 8;
+    const int RatingCountRole = Qt::UserRole + 9;
+}
+
+// Модель каталогу для сітки книг (QListView у режимі IconMode).
+// Дані завантажуються сторінками через DatabaseManager::getBooksPageAsync:
+// перша сторінка — при зміні фільтра, наступні — коли view викликає fetchMore()
+// (прокрутка до кінця або незаповнена видима область).
+// Якщо встановлено знімок каталогу (CatalogSnapshot), фільтр обчислюється локально
+// і модель одразу містить увесь результат — без запитів до БД.
+class BookGridModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit BookGridModel(DatabaseManager *dbManager, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    // Скидає модель і завантажує першу сторінку за новими критеріями
+    void setFilterCriteria(const BookFilterCriteria &criteria);
+    void setPageSize(int pageSize);
+    // Перемикає модель на локальну фільтрацію (nullptr — назад на посторінкові запити)
+    // і повторно застосовує поточні критерії
+    void setCatalogSnapshot(const QSharedPointer<const CatalogSnapshot> &snapshot);
+    // Той самий каталог з оновленими рядками: якщо набір відфільтрованих рядків не змінився,
+    // лише перемальовує картки (dataChanged) без скидання моделі та позиції прокрутки
+    void updateCatalogSnapshot(const QSharedPointer<const CatalogSnapshot> &snapshot);
+    QSharedPointer<const CatalogSnapshot> catalogSnapshot() const { return m_snapshot; }
+
+    BookDisplayInfo bookAt(int row) const;
+
+signals:
+    void firstPageLoaded(int count);
+    void pageLoaded(int totalLoaded, bool hasMore);
+
+private:
+    void requestNextPage();
+    void applySnapshotFilter();
+
+    DatabaseManager *m_dbManager = nullptr;
+    QList<BookDisplayInfo> m_books;
+    QSharedPointer<const CatalogSnapshot> m_snapshot;
+    QVector<int> m_snapshotRows; // Рядки знімка, що пройшли фільтр, у порядку сортування
+    BookFilterCriteria m_criteria;
+    BookPageCursor m_cursor;
+    bool m_hasMore = false;
+    bool m_loading = false;
+    int m_generation = 0; // Відповіді на запити для попередніх критеріїв ігноруються
+    int m_pageSize = 48;
+};
+
+#endif // BOOKGRIDMODEL_H
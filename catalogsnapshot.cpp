@@ -0,0 +1,173 @@
+#include "catalogsnapshot.h"
+#include <QtMath>
+#include <algorithm>
+#include <numeric>
+
+void CatalogSnapshot::appendBook(const BookDisplayInfo &book, const QString &language, int ratingAvgCents)
+{
+    m_bookIds.append(book.bookId);
+    m_titles.append(book.title);
+    m_authors.append(book.authors);
+    m_coverImagePaths.append(book.coverImagePath);
+    m_prices.append(book.price);
+    m_stockQuantities.append(book.stockQuantity);
+    m_genreIds.append(internValue(book.genre, m_genres, m_genreLookup));
+    m_languageIds.append(internValue(language, m_languages, m_languageLookup));
+    m_ratingSums.append(book.ratingSum);
+    m_ratingCounts.append(book.ratingCount);
+    m_ratingAvgCents.append(ratingAvgCents);
+}
+
+void CatalogSnapshot::finalize()
+{
+    m_rowByBookId.clear();
+    m_rowByBookId.reserve(size());
+    for (int row = 0; row < size(); ++row) {
+        m_rowByBookId.insert(m_bookIds[row], row);
+    }
+    buildRatingOrder();
+}
+
+bool CatalogSnapshot::updateBook(const BookChangeInfo &change)
+{
+    const auto it = m_rowByBookId.constFind(change.book.bookId);
+    if (it == m_rowByBookId.constEnd()) {
+        return false;
+    }
+    const int row = it.value();
+    if (m_titles.at(row) != change.book.title) {
+        return false;
+    }
+
+    m_authors[row] = change.book.authors;
+    m_coverImagePaths[row] = change.book.coverImagePath;
+    m_prices[row] = change.book.price;
+    m_stockQuantities[row] = change.book.stockQuantity;
+    m_genreIds[row] = internValue(change.book.genre, m_genres, m_genreLookup);
+    m_languageIds[row] = internValue(change.language, m_languages, m_languageLookup);
+    m_ratingSums[row] = change.book.ratingSum;
+    m_ratingCounts[row] = change.book.ratingCount;
+    if (m_ratingAvgCents.at(row) != change.ratingAvgCents) {
+        m_ratingAvgCents[row] = change.ratingAvgCents;
+        buildRatingOrder();
+    }
+    return true;
+}
+
+void CatalogSnapshot::buildRatingOrder()
+{
+    m_ratingOrder.resize(size());
+    std::iota(m_ratingOrder.begin(), m_ratingOrder.end(), 0);
+    std::sort(m_ratingOrder.begin(), m_ratingOrder.end(), [this](int a, int b) {
+        if (m_ratingAvgCents[a] != m_ratingAvgCents[b]) {
+            return m_ratingAvgCents[a] > m_ratingAvgCents[b];
+        }
+        return m_bookIds[a] < m_bookIds[b];
+    });
+}
+
+int CatalogSnapshot::internValue(const QString &value, QStringList &dictionary, QHash<QString, int> &lookup)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+    auto it = lookup.constFind(value);
+    if (it != lookup.constEnd()) {
+        return it.value();
+    }
+    dictionary.append(value);
+    const int id = dictionary.size(); // Індекс + 1: нуль зарезервовано для порожнього значення
+    lookup.insert(value, id);
+    return id;
+}
+
+// Таблиця допустимих ідентифікаторів для фільтра "значення IN (...)"
+QVector<quint8> CatalogSnapshot::dictionaryMask(const QStringList &values, const QHash<QString, int> &lookup, int dictionarySize)
+{
+    QVector<quint8> allowed(dictionarySize + 1, 0);
+    for (const QString &value : values) {
+        const int id = lookup.value(value, 0);
+        if (id > 0) {
+            allowed[id] = 1;
+        }
+    }
+    return allowed;
+}
+
+QVector<int> CatalogSnapshot::filter(const BookFilterCriteria &criteria) const
+{
+    const int count = size();
+    QVector<quint8> mask(count, 1);
+    quint8 *maskData = mask.data();
+
+    // Кожен предикат — окремий прохід по одній колонці без розгалужень у тілі циклу
+    if (!criteria.genres.isEmpty()) {
+        const QVector<quint8> allowed = dictionaryMask(criteria.genres, m_genreLookup, m_genres.size());
+        const quint8 *allowedData = allowed.constData();
+        const int *ids = m_genreIds.constData();
+        for (int i = 0; i < count; ++i) {
+            maskData[i] &= allowedData[ids[i]];
+        }
+    }
+    if (!criteria.languages.isEmpty()) {
+        const QVector<quint8> allowed = dictionaryMask(criteria.languages, m_languageLookup, m_languages.size());
+        const quint8 *allowedData = allowed.constData();
+        const int *ids = m_languageIds.constData();
+        for (int i = 0; i < count; ++i) {
+            maskData[i] &= allowedData[ids[i]];
+        }
+    }
+    const double *prices = m_prices.constData();
+    if (criteria.minPrice >= 0.0) {
+        const double minPrice = criteria.minPrice;
+        for (int i = 0; i < count; ++i) {
+            maskData[i] &= static_cast<quint8>(prices[i] >= minPrice);
+        }
+    }
+    if (criteria.maxPrice >= 0.0) {
+        const double maxPrice = criteria.maxPrice;
+        for (int i = 0; i < count; ++i) {
+            maskData[i] &= static_cast<quint8>(prices[i] <= maxPrice);
+        }
+    }
+    if (criteria.inStockOnly) {
+        const int *stock = m_stockQuantities.constData();
+        for (int i = 0; i < count; ++i) {
+            maskData[i] &= static_cast<quint8>(stock[i] > 0);
+        }
+    }
+
+    QVector<int> rows;
+    if (criteria.sortOrder == BookFilterCriteria::SortOrder::Rating) {
+        for (int row : m_ratingOrder) {
+            if (maskData[row]) rows.append(row);
+        }
+    } else {
+        for (int row = 0; row < count; ++row) {
+            if (maskData[row]) rows.append(row);
+        }
+    }
+    return rows;
+}
+
+BookDisplayInfo CatalogSnapshot::bookAt(int row) const
+{
+    BookDisplayInfo book;
+    if (row < 0 || row >= size()) {
+        book.bookId = -1;
+        book.price = 0.0;
+        book.stockQuantity = 0;
+        return book;
+    }
+    book.bookId = m_bookIds[row];
+    book.title = m_titles[row];
+    book.authors = m_authors[row];
+    book.coverImagePath = m_coverImagePaths[row];
+    book.price = qIsNaN(m_prices[row]) ? 0.0 : m_prices[row];
+    book.stockQuantity = m_stockQuantities[row];
+    book.genre = m_genreIds[row] > 0 ? m_genres[m_genreIds[row] - 1] : QString();
+    book.ratingSum = m_ratingSums[row];
+    book.ratingCount = m_ratingCounts[row];
+    book.found = true;
+    return book;
+}
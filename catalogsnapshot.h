@@ -0,0 +1,59 @@
+#ifndef CATALOGSNAPSHOT_H
+#define CATALOGSNAPSHOT_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "datatypes.h"
+
+// Знімок каталогу в пам'яті для локальної фільтрації без запитів до БД.
+// Дані зберігаються по колонках (struct-of-arrays): предикати BookFilterCriteria
+// проходять суцільними масивами price/stock/genre/language і заповнюють байтову маску,
+// а результат збирається у вже готовому порядку сортування (за назвою або рейтингом).
+// Жанри та мови закодовані як індекси словника + 1 (0 — значення NULL/порожнє).
+class CatalogSnapshot
+{
+public:
+    // Рядки мають надходити в порядку сортування за назвою (ORDER BY title, book_id)
+    void appendBook(const BookDisplayInfo &book, const QString &language, int ratingAvgCents);
+    // Будує порядок за рейтингом; викликається один раз після завантаження всіх рядків
+    void finalize();
+    // Оновлює рядок книги на місці (сповіщення про UPDATE). false — книги немає в знімку
+    // або змінилась назва (позиція в сортуванні): потрібне повне перезавантаження.
+    // Знімок спільний між моделлю та викликачем, тож оновлюють копію (колонки QVector детачаться).
+    bool updateBook(const BookChangeInfo &change);
+
+    int size() const { return m_bookIds.size(); }
+    bool isEmpty() const { return m_bookIds.isEmpty(); }
+
+    // Індекси рядків, що задовольняють критерії, у порядку criteria.sortOrder
+    QVector<int> filter(const BookFilterCriteria &criteria) const;
+    BookDisplayInfo bookAt(int row) const;
+
+private:
+    void buildRatingOrder();
+    static int internValue(const QString &value, QStringList &dictionary, QHash<QString, int> &lookup);
+    static QVector<quint8> dictionaryMask(const QStringList &values, const QHash<QString, int> &lookup, int dictionarySize);
+
+    QVector<int> m_bookIds;
+    QVector<QString> m_titles;
+    QVector<QString> m_authors;
+    QVector<QString> m_coverImagePaths;
+    QVector<double> m_prices; // NaN для NULL: не проходить жоден ціновий фільтр, як і в SQL
+    QVector<int> m_stockQuantities;
+    QVector<int> m_genreIds;
+    QVector<int> m_languageIds;
+    QVector<int> m_ratingSums;
+    QVector<int> m_ratingCounts;
+    QVector<int> m_ratingAvgCents; // book.rating_avg * 100 — точне порівняння NUMERIC(3,2)
+    QVector<int> m_ratingOrder;    // Перестановка рядків: rating_avg DESC, book_id
+    QHash<int, int> m_rowByBookId;
+
+    QStringList m_genres;
+    QHash<QString, int> m_genreLookup;
+    QStringList m_languages;
+    QHash<QString, int> m_languageLookup;
+};
+
+#endif // CATALOGSNAPSHOT_H
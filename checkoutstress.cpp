@@ -0,0 +1,97 @@
+#include "checkoutstress.h"
+#include "database.h"
+#include "databaseconnectionpool.h"
+#include <QAtomicInt>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QThread>
+
+CheckoutStressResult CheckoutStress::run(DatabaseManager *dbManager, const CheckoutStressOptions &options)
+{
+    CheckoutStressResult result;
+    if (!dbManager || !dbManager->isConnected() || !dbManager->connectionConfig().isValid()) {
+        qWarning() << "CheckoutStress: немає активного з'єднання з БД.";
+        return result;
+    }
+
+    BookFilterCriteria criteria;
+    criteria.inStockOnly = true;
+    const QList<BookDisplayInfo> books = dbManager->getBooksPage(criteria, BookPageCursor(), qMax(1, options.hotBooks)).books;
+    if (books.isEmpty()) {
+        qWarning() << "CheckoutStress: немає книг у наявності для навантаження.";
+        return result;
+    }
+    QList<int> hotBookIds;
+    for (const BookDisplayInfo &book : books) {
+        hotBookIds.append(book.bookId);
+    }
+
+    const int concurrency = qMax(1, options.concurrency);
+    qInfo() << "CheckoutStress:" << options.orders << "замовлень," << concurrency << "паралельних кас, книги" << hotBookIds;
+
+    DatabaseConnectionPool pool(dbManager->connectionConfig(), concurrency);
+    QAtomicInt nextOrder(0);
+    QAtomicInt succeeded(0);
+    QAtomicInt failed(0);
+    QAtomicInt retries(0);
+
+    QList<QThread *> threads;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < concurrency; ++i) {
+        QThread *thread = QThread::create([&]() {
+            DatabaseManager worker;
+            worker.adoptConnection(pool.acquire());
+            if (!worker.isConnected()) {
+                qWarning() << "CheckoutStress: потік не отримав з'єднання з пулу.";
+                return;
+            }
+            QRandomGenerator random(QRandomGenerator::global()->generate());
+            while (nextOrder.fetchAndAddRelaxed(1) < options.orders) {
+                // Кожен кошик — випадкова непорожня підмножина гарячих книг, тож кошики перетинаються
+                QMap<int, int> items;
+                for (int bookId : hotBookIds) {
+                    if (random.bounded(2) == 1) items.insert(bookId, 1);
+                }
+                if (items.isEmpty()) {
+                    items.insert(hotBookIds.at(random.bounded(hotBookIds.size())), 1);
+                }
+
+                int newOrderId = -1;
+                const double total = worker.createOrder(options.customerId, items, "Checkout stress test", QString(), newOrderId);
+                if (total >= 0.0) {
+                    succeeded.ref();
+                } else {
+                    failed.ref();
+                }
+                retries.fetchAndAddRelaxed(qMax(0, worker.lastOrderAttempts() - 1));
+            }
+            worker.closeConnection();
+            pool.closeCurrentThreadConnection();
+        });
+        threads.append(thread);
+        thread->start();
+    }
+    for (QThread *thread : std::as_const(threads)) {
+        thread->wait();
+        delete thread;
+    }
+
+    result.elapsedMs = timer.elapsed();
+    result.succeeded = succeeded.loadRelaxed();
+    result.failed = failed.loadRelaxed();
+    result.attempted = result.succeeded + result.failed;
+    result.conflictRetries = retries.loadRelaxed();
+
+    qInfo().noquote() << QString("CheckoutStress: %1 замовлень за %2 мс, успішних %3 (%4 замовл./с), відмов %5 (%6%), повторів через конфлікти %7")
+                             .arg(result.attempted)
+                             .arg(result.elapsedMs)
+                             .arg(result.succeeded)
+                             .arg(result.throughput(), 0, 'f', 1)
+                             .arg(result.failed)
+                             .arg(result.abortRate() * 100.0, 0, 'f', 1)
+                             .arg(result.conflictRetries);
+    return result;
+}
@@ -0,0 +1,37 @@
+#ifndef CHECKOUTSTRESS_H
+#define CHECKOUTSTRESS_H
+
+#include <QList>
+#include <QtGlobal>
+
+class DatabaseManager;
+
+// Навантажувальна перевірка оформлення замовлень: N потоків, кожен зі своїм
+// з'єднанням, одночасно викликають createOrder() для тих самих "гарячих" книг.
+// Увага: замовлення створюються по-справжньому і списують залишки на складі.
+struct CheckoutStressOptions {
+    int orders = 200;      // Загальна кількість замовлень
+    int concurrency = 8;   // Кількість паралельних кас (потоків і з'єднань)
+    int hotBooks = 3;      // Скільки книг, що є в наявності, використовується в кошиках
+    int customerId = 1;    // Покупець, від імені якого створюються замовлення
+};
+
+struct CheckoutStressResult {
+    int attempted = 0;
+    int succeeded = 0;
+    int failed = 0;          // Замовлення, що не вдалося створити (зокрема через вичерпані залишки)
+    int conflictRetries = 0; // Повтори транзакцій через 40001/40P01
+    qint64 elapsedMs = 0;
+
+    double throughput() const { return elapsedMs > 0 ? succeeded * 1000.0 / elapsedMs : 0.0; }
+    double abortRate() const { return attempted > 0 ? static_cast<double>(failed) / attempted : 0.0; }
+};
+
+class CheckoutStress
+{
+public:
+    // dbManager — підключений менеджер, з якого беруться параметри з'єднання та список книг
+    static CheckoutStressResult run(DatabaseManager *dbManager, const CheckoutStressOptions &options);
+};
+
+#endif // CHECKOUTSTRESS_H
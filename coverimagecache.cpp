@@ -0,0 +1,142 @@
+#include "coverimagecache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+CoverImageCache &CoverImageCache::instance()
+{
+    static CoverImageCache cache;
+    return cache;
+}
+
+CoverImageCache::CoverImageCache()
+{
+    setMemoryLimitKb(48 * 1024); // ~48 МБ зменшених зображень
+}
+
+void CoverImageCache::setMemoryLimitKb(int limitKb)
+{
+    m_memoryCache.setMaxCost(qMax(1024, limitKb));
+}
+
+CoverImageCache::Stats CoverImageCache::stats() const
+{
+    return m_stats;
+}
+
+QString CoverImageCache::memoryKey(const QString &path, const QSize &size, Qt::AspectRatioMode mode)
+{
+    return QString("%1|%2x%3|%4").arg(path).arg(size.width()).arg(size.height()).arg(static_cast<int>(mode));
+}
+
+QString CoverImageCache::thumbnailDirectory()
+{
+    static const QString directory = [] {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/covers";
+        QDir().mkpath(dir);
+        return dir;
+    }();
+    return directory;
+}
+
+QString CoverImageCache::thumbnailPath(const QString &path, const QSize &size, Qt::AspectRatioMode mode)
+{
+    // Час зміни оригіналу входить у ключ: оновлена обкладинка отримає нову мініатюру
+    const QFileInfo sourceInfo(path);
+    const QString source = memoryKey(path, size, mode) + "|" + QString::number(sourceInfo.lastModified().toMSecsSinceEpoch());
+    const QByteArray hash = QCryptographicHash::hash(source.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return thumbnailDirectory() + "/" + QString::fromLatin1(hash) + ".png";
+}
+
+bool CoverImageCache::findInMemory(const QString &path, const QSize &size, Qt::AspectRatioMode mode, QPixmap *pixmap) const
+{
+    const QPixmap *cached = m_memoryCache.object(memoryKey(path, size, mode));
+    if (!cached) {
+        return false;
+    }
+    if (pixmap) {
+        *pixmap = *cached;
+    }
+    m_stats.memoryHits++;
+    return true;
+}
+
+void CoverImageCache::insertInMemory(const QString &path, const QSize &size, Qt::AspectRatioMode mode, const QPixmap &pixmap)
+{
+    if (pixmap.isNull()) {
+        return;
+    }
+    const int costKb = qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024);
+    m_memoryCache.insert(memoryKey(path, size, mode), new QPixmap(pixmap), costKb);
+}
+
+QPixmap CoverImageCache::pixmap(const QString &path, const QSize &size, Qt::AspectRatioMode mode)
+{
+    if (path.isEmpty() || !size.isValid()) {
+        return QPixmap();
+    }
+
+    QPixmap result;
+    if (findInMemory(path, size, mode, &result)) {
+        return result;
+    }
+
+    bool fromDisk = false;
+    const QImage image = loadScaledImage(path, size, mode, &fromDisk);
+    if (image.isNull()) {
+        return QPixmap();
+    }
+    if (fromDisk) {
+        m_stats.diskHits++;
+    } else {
+        m_stats.misses++;
+    }
+
+    result = QPixmap::fromImage(image);
+    insertInMemory(path, size, mode, result);
+    return result;
+}
+
+QImage CoverImageCache::loadScaledImage(const QString &path, const QSize &size, Qt::AspectRatioMode mode, bool *fromDisk)
+{
+    if (fromDisk) *fromDisk = false;
+    if (path.isEmpty() || !size.isValid()) {
+        return QImage();
+    }
+
+    const QString thumbPath = thumbnailPath(path, size, mode);
+    QImage image;
+    if (QFileInfo::exists(thumbPath) && image.load(thumbPath)) {
+        if (fromDisk) *fromDisk = true;
+        return image;
+    }
+
+    // Декодуємо одразу в цільовий розмір: для JPEG це значно швидше й не тримає
+    // в пам'яті повнорозмірне зображення
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    const QSize sourceSize = reader.size();
+    if (sourceSize.isValid()) {
+        reader.setScaledSize(sourceSize.scaled(size, mode));
+    }
+    if (!reader.read(&image)) {
+        return QImage();
+    }
+    if (!sourceSize.isValid()) {
+        image = image.scaled(size, mode, Qt::SmoothTransformation);
+    }
+
+    // Запис через тимчасовий файл: інший потік не прочитає напівзаписану мініатюру
+    QSaveFile thumbFile(thumbPath);
+    if (thumbFile.open(QIODevice::WriteOnly) && image.save(&thumbFile, "PNG")) {
+        thumbFile.commit();
+    } else {
+        qWarning() << "CoverImageCache: не вдалося зберегти мініатюру" << thumbPath;
+    }
+    return image;
+}
@@ -0,0 +1,50 @@
+#ifndef COVERIMAGECACHE_H
+#define COVERIMAGECACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+
+// Дворівневий кеш обкладинок та фото:
+//  1) у пам'яті — LRU (QCache) уже зменшених QPixmap за ключем (шлях, розмір, режим масштабування);
+//  2) на диску — мініатюри у каталозі кешу програми, щоб після перезапуску не декодувати
+//     повнорозмірні зображення повторно.
+// Кожне зображення декодується та масштабується не більше одного разу для кожного розміру.
+class CoverImageCache
+{
+public:
+    struct Stats {
+        quint64 memoryHits = 0;
+        quint64 diskHits = 0;
+        quint64 misses = 0;
+    };
+
+    static CoverImageCache &instance();
+
+    // Лише для GUI-потоку. Порожній QPixmap, якщо файл відсутній або не читається.
+    QPixmap pixmap(const QString &path, const QSize &size, Qt::AspectRatioMode mode = Qt::KeepAspectRatio);
+    // Лише з пам'яті, без звернення до диска (для частих перемальовувань)
+    bool findInMemory(const QString &path, const QSize &size, Qt::AspectRatioMode mode, QPixmap *pixmap) const;
+    void insertInMemory(const QString &path, const QSize &size, Qt::AspectRatioMode mode, const QPixmap &pixmap);
+
+    // Потокобезпечне завантаження зменшеного зображення: спершу мініатюра з диска,
+    // інакше декодування оригіналу, масштабування та збереження мініатюри.
+    static QImage loadScaledImage(const QString &path, const QSize &size, Qt::AspectRatioMode mode, bool *fromDisk = nullptr);
+
+    void setMemoryLimitKb(int limitKb);
+    Stats stats() const;
+
+private:
+    CoverImageCache();
+
+    static QString memoryKey(const QString &path, const QSize &size, Qt::AspectRatioMode mode);
+    static QString thumbnailPath(const QString &path, const QSize &size, Qt::AspectRatioMode mode);
+    static QString thumbnailDirectory();
+
+    QCache<QString, QPixmap> m_memoryCache; // Вартість запису — розмір пікселів у КБ
+    mutable Stats m_stats;
+};
+
+#endif // COVERIMAGECACHE_H
@@ -16,15 +16,40 @@
 #include <QTextStream> // Для читання файлів
 #include <QDir>     // Для роботи з директоріями
 #include <QCryptographicHash> // Додано для хешування паролів
+#include <QPointer>
+#include <QHash>
+#include <QSharedPointer>
+#include <QMetaObject>
+#include <functional>
 #include "datatypes.h"
 
 class QSqlQuery;
+class QThread;
+class DatabaseWorker;
+class DatabaseConnectionPool;
+class CatalogSnapshot;
+
+// Параметри підключення, з яких фонові потоки відкривають власні з'єднання
+struct DatabaseConnectionConfig {
+    QString host;
+    int port = 5432;
+    QString dbName;
+    QString user;
+    QString password;
+    bool isValid() const { return !host.isEmpty() && !dbName.isEmpty(); }
+};
 
 class DatabaseManager : public QObject
 {
     Q_OBJECT
 
 public:
+    // Prefix — збіг з початком назви (як раніше); Fuzzy — підрядок та схожість за триграмами (pg_trgm)
+    enum class SearchMode { Prefix, Fuzzy };
+    // Тип зміни рядка у сповіщенні bookstore_changes (TG_OP тригера)
+    enum class ChangeOperation { Insert, Update, Delete };
+    Q_ENUM(ChangeOperation)
+
     explicit DatabaseManager(QObject *parent = nullptr);
     ~DatabaseManager();
 
@@ -35,6 +60,12 @@ public:
                            const QString &password);
 
     bool createSchemaTables();
+    // Перевіряє наявність індексів із sql/indexes.sql; відсутні створює, якщо createMissing
+    bool verifyIndexes(bool createMissing = true);
+    // Додає до існуючої БД колонки, функції та тригери, що з'явилися після її створення
+    bool upgradeSchema();
+    // LISTEN bookstore_changes на цьому з'єднанні: зміни з інших кас приходять як сигнали нижче
+    bool startChangeNotifications();
 
     QSqlError lastError() const;
     void closeConnection();
@@ -62,7 +93,11 @@ public:
 
     bool addLoyaltyPoints(int customerId, int pointsToAdd);
 
-    QList<SearchSuggestionInfo> getSearchSuggestions(const QString &prefix, int limit = 10) const;
+    QList<SearchSuggestionInfo> getSearchSuggestions(const QString &prefix, int limit = 10, SearchMode mode = SearchMode::Prefix) const;
+    // Чи встановлено pg_trgm (режим SearchMode::Fuzzy)
+    bool isFuzzySearchAvailable() const;
+    // Книги та автори з id більшими за вказані — для клієнтського префіксного індексу
+    QList<SearchSuggestionInfo> getSearchIndexEntries(int afterBookId = 0, int afterAuthorId = 0) const;
 
     BookDetailsInfo getBookDetails(int bookId) const;
 
@@ -70,7 +105,12 @@ public:
 
     BookDisplayInfo getBookDisplayInfoById(int bookId) const;
 
-    double createOrder(int customerId, const QMap<int, int> &items, const QString &shippingAddress, const QString &paymentMethod, int &newOrderId);
+    // В одній транзакції: замовлення, бонусні бали та видалення позицій з кошика.
+    // Транзакція повторюється (до 4 спроб) при serialization failure / deadlock
+    double createOrder(int customerId, const QMap<int, int> &items, const QString &shippingAddress, const QString &paymentMethod, int &newOrderId,
+                       int *loyaltyPointsAwarded = nullptr);
+    // Кількість спроб, витрачених останнім createOrder() на цьому з'єднанні
+    int lastOrderAttempts() const;
 
     bool addComment(int bookId, int customerId, const QString &commentText, int rating);
 
@@ -80,9 +120,16 @@ public:
 
     AuthorDetailsInfo getAuthorDetails(int authorId) const;
 
+    // Спершу сусіди з book_similarity (спільні покупки), решта — випадкові книги того ж жанру
     QList<BookDisplayInfo> getSimilarBooks(int currentBookId, const QString &genre, int limit = 5) const;
+    // Перераховує top-K схожих книг для кожної книги за order_item (пакетна задача)
+    bool rebuildBookSimilarity(int topK = 10);
 
     QList<BookDisplayInfo> getFilteredBooksForDisplay(const BookFilterCriteria &criteria) const;
+    // Одна сторінка каталогу (keyset за title, book_id) — для нескінченної прокрутки
+    BookPage getBooksPage(const BookFilterCriteria &criteria, const BookPageCursor &cursor, int pageSize = 60) const;
+    // Увесь каталог у колонковому вигляді для локальної фільтрації (порожній знімок при помилці)
+    CatalogSnapshot getCatalogSnapshot() const;
 
     QStringList getAllGenres() const;
     QStringList getAllLanguages() const;
@@ -90,6 +137,8 @@ public:
     QMap<int, int> getCartItems(int customerId) const;
     bool addOrUpdateCartItem(int customerId, int bookId, int quantity);
     bool removeCartItem(int customerId, int bookId);
+    // Пакетний запис змін кошика: bookId -> нова кількість (0 — видалити позицію)
+    bool applyCartChanges(int customerId, const QMap<int, int> &changes);
     bool clearCart(int customerId);
 
     bool isConnected() const;
@@ -102,12 +151,108 @@ public:
 
     bool executeInsertQuery(QSqlQuery &query, const QString &description, QVariant &insertedId);
 
+    // Статистика кешу підготовлених запитів поточного з'єднання
+    struct PreparedStatementStats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        int cachedStatements = 0;
+    };
+    PreparedStatementStats preparedStatementStats() const;
+
+    // Використати вже відкрите з'єднання (з пулу) без права власності:
+    // closeConnection() лише відпускає його, не закриваючи.
+    void adoptConnection(const QSqlDatabase &db);
+
+    // --- Асинхронний API (database_async.cpp) ---
+    // Завдання виконуються у фонових потоках, кожен з яких отримує власне
+    // з'єднання з DatabaseConnectionPool, а результат повертається у потік
+    // об'єкта context через чергу подій. Незалежні запити виконуються паралельно.
+    // Якщо context знищено до завершення запиту, колбек не викликається.
+    DatabaseConnectionConfig connectionConfig() const;
+    void setAsyncPoolSize(int maxConnections);
+    void submitAsync(const std::function<void(DatabaseManager *)> &task);
+
+    template <typename Result>
+    void runAsync(QObject *context,
+                  const std::function<Result(DatabaseManager *)> &job,
+                  const std::function<void(const Result &)> &onFinished)
+    {
+        QPointer<QObject> guard(context);
+        submitAsync([job, onFinished, guard](DatabaseManager *workerDb) {
+            const Result result = job(workerDb);
+            if (!guard) return;
+            QMetaObject::invokeMethod(guard.data(), [guard, onFinished, result]() {
+                if (guard && onFinished) onFinished(result);
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    void getAllBooksForDisplayAsync(QObject *context, const std::function<void(const QList<BookDisplayInfo> &)> &onFinished);
+    void getFilteredBooksForDisplayAsync(const BookFilterCriteria &criteria, QObject *context, const std::function<void(const QList<BookDisplayInfo> &)> &onFinished);
+    void getBooksPageAsync(const BookFilterCriteria &criteria, const BookPageCursor &cursor, int pageSize, QObject *context, const std::function<void(const BookPage &)> &onFinished);
+    void getCatalogSnapshotAsync(QObject *context, const std::function<void(const CatalogSnapshot &)> &onFinished);
+    void getBooksByGenreAsync(const QString &genre, int limit, QObject *context, const std::function<void(const QList<BookDisplayInfo> &)> &onFinished);
+    void getAllAuthorsForDisplayAsync(QObject *context, const std::function<void(const QList<AuthorDisplayInfo> &)> &onFinished);
+    void getCustomerOrdersForDisplayAsync(int customerId, QObject *context, const std::function<void(const QList<OrderDisplayInfo> &)> &onFinished);
+    void getSearchSuggestionsAsync(const QString &prefix, int limit, SearchMode mode, QObject *context, const std::function<void(const QList<SearchSuggestionInfo> &)> &onFinished);
+    void getSearchIndexEntriesAsync(int afterBookId, int afterAuthorId, QObject *context, const std::function<void(const QList<SearchSuggestionInfo> &)> &onFinished);
+    void rebuildBookSimilarityAsync(int topK, QObject *context, const std::function<void(bool)> &onFinished);
+    void createOrderAsync(int customerId, const QMap<int, int> &items, const QString &shippingAddress, const QString &paymentMethod,
+                          QObject *context, const std::function<void(double total, int newOrderId, int loyaltyPointsAwarded)> &onFinished);
+
+    void stopAsyncWorkers();
+
+signals:
+    // Сповіщення тригерів sql/functions/change_notifications.sql (після startChangeNotifications).
+    // fromThisConnection = true, якщо зміну зробило з'єднання цього ж менеджера або його фонових потоків (пулу).
+    void bookChanged(const BookChangeInfo &change, DatabaseManager::ChangeOperation operation);
+    void authorChanged(const AuthorDisplayInfo &author, DatabaseManager::ChangeOperation operation);
+    void commentChanged(int bookId, int commentId, DatabaseManager::ChangeOperation operation);
+    void orderStatusChanged(int orderId, const QString &status, DatabaseManager::ChangeOperation operation);
+    void cartItemChanged(int customerId, int bookId, int quantity, DatabaseManager::ChangeOperation operation, bool fromThisConnection);
+
 private:
+    void startAsyncWorkers();
+
+    bool createSearchExtensions();
     bool loadSqlQueries(const QString& directory = "sql");
-    bool parseSqlFile(const QString& filePath);
+    bool parseSqlFile(const QString& filePath, QStringList *parsedQueryNames = nullptr);
+    bool createManagedIndexes(QSqlQuery &query);
+    bool createBookAuthorsTextObjects(QSqlQuery &query);
+    bool createBookRatingObjects(QSqlQuery &query);
+    bool createChangeNotificationObjects(QSqlQuery &query);
+    bool indexExists(const QString &indexName) const;
+    bool functionSourceContains(const QString &functionName, const QString &fragment) const;
+    bool triggerHasArgument(const QString &tableName, const QString &triggerName, const QString &argument) const;
+    void handleChangeNotification(const QString &payload, bool fromThisConnection);
+    bool columnExists(const QString &tableName, const QString &columnName) const;
+    double placeOrderAttempt(int customerId, const QList<int> &bookIds, const QList<int> &quantities,
+                             const QString &shippingAddress, const QString &paymentMethod,
+                             int &newOrderId, int &loyaltyPointsAwarded, bool &retryable);
+    static QString indexNameFromSql(const QString &sql);
     QString getSqlQuery(const QString& queryName) const;
+    // Повертає підготовлений запит з кешу з'єднання: prepare() виконується лише
+    // при першому зверненні за іменем (-- name:), далі — тільки bind та exec.
+    QSqlQuery *preparedQuery(const QString& queryName) const;
+    void clearPreparedQueries() const;
+    // Формує літерал масиву PostgreSQL ('{1,2,3}') для параметрів "= ANY(CAST(:ids AS INTEGER[]))"
+    static QString toPostgresIntArray(const QList<int> &ids);
+    static QStringList buildBookFilterConditions(const BookFilterCriteria &criteria, QMap<QString, QVariant> &bindValues);
 
     QMap<QString, QString> m_sqlQueries;
+    QStringList m_managedIndexQueries; // Імена запитів з sql/indexes.sql у порядку оголошення
+    mutable QHash<QString, QSharedPointer<QSqlQuery>> m_preparedQueries;
+    mutable quint64 m_preparedQueryHits = 0;
+    mutable quint64 m_preparedQueryMisses = 0;
+
+    bool m_ownsConnection = true;
+    int m_lastOrderAttempts = 0;
+
+    DatabaseConnectionConfig m_connectionConfig;
+    DatabaseConnectionPool *m_connectionPool = nullptr;
+    QList<QThread *> m_asyncThreads;
+    QList<DatabaseWorker *> m_asyncWorkers;
+    int m_asyncPoolSize = 4;
 };
 
 #endif // DATABASE_H
@@ -0,0 +1,184 @@
+#include "database.h"
+#include "databaseworker.h"
+#include "databaseconnectionpool.h"
+#include <QDebug>
+#include <QThread>
+
+// --- Асинхронний API DatabaseManager ---
+// Запити виконуються у кількох фонових потоках DatabaseWorker. Кожен потік бере
+// власне з'єднання з DatabaseConnectionPool (QSqlDatabase не можна використовувати
+// з кількох потоків), тому незалежні завантаження виконуються паралельно.
+// Нове завдання отримує воркер з найменшою чергою.
+
+DatabaseConnectionConfig DatabaseManager::connectionConfig() const
+{
+    return m_connectionConfig;
+}
+
+void DatabaseManager::setAsyncPoolSize(int maxConnections)
+{
+    if (!m_asyncThreads.isEmpty()) {
+        qWarning() << "setAsyncPoolSize: пул уже запущено, новий розмір буде застосовано після перепідключення.";
+    }
+    m_asyncPoolSize = qMax(1, maxConnections);
+}
+
+void DatabaseManager::startAsyncWorkers()
+{
+    if (!m_asyncThreads.isEmpty()) {
+        return;
+    }
+    if (!m_connectionConfig.isValid()) {
+        qWarning() << "startAsyncWorkers: немає параметрів підключення, фонові потоки не запущено.";
+        return;
+    }
+
+    m_connectionPool = new DatabaseConnectionPool(m_connectionConfig, m_asyncPoolSize);
+
+    for (int i = 0; i < m_asyncPoolSize; ++i) {
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QString("DatabaseWorkerThread_%1").arg(i));
+        DatabaseWorker *worker = new DatabaseWorker(m_connectionPool);
+        worker->moveToThread(thread);
+
+        connect(thread, &QThread::started, worker, &DatabaseWorker::initialize);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+
+        thread->start();
+        m_asyncThreads.append(thread);
+        m_asyncWorkers.append(worker);
+    }
+    qInfo() << "Запущено" << m_asyncThreads.size() << "фонових потоків DatabaseManager (розмір пулу з'єднань:" << m_asyncPoolSize << ").";
+}
+
+void DatabaseManager::stopAsyncWorkers()
+{
+    if (m_asyncThreads.isEmpty()) {
+        return;
+    }
+
+    for (QThread *thread : std::as_const(m_asyncThreads)) {
+        thread->quit();
+    }
+    for (QThread *thread : std::as_const(m_asyncThreads)) {
+        thread->wait(); // Воркери знищуються через deleteLater і закривають свої з'єднання
+        delete thread;
+    }
+    m_asyncThreads.clear();
+    m_asyncWorkers.clear();
+
+    delete m_connectionPool;
+    m_connectionPool = nullptr;
+    qInfo() << "Фонові потоки DatabaseManager зупинено.";
+}
+
+void DatabaseManager::submitAsync(const std::function<void(DatabaseManager *)> &task)
+{
+    if (!task) {
+        return;
+    }
+    startAsyncWorkers();
+    if (m_asyncWorkers.isEmpty()) {
+        qWarning() << "submitAsync: фонові потоки недоступні, завдання відхилено.";
+        return;
+    }
+
+    DatabaseWorker *worker = m_asyncWorkers.first();
+    for (DatabaseWorker *candidate : std::as_const(m_asyncWorkers)) {
+        if (candidate->pendingTasks() < worker->pendingTasks()) {
+            worker = candidate;
+        }
+    }
+
+    worker->markTaskQueued();
+    QMetaObject::invokeMethod(worker, [worker, task]() {
+        worker->runTask(task);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseManager::getAllBooksForDisplayAsync(QObject *context, const std::function<void(const QList<BookDisplayInfo> &)> &onFinished)
+{
+    runAsync<QList<BookDisplayInfo>>(context, [](DatabaseManager *db) {
+        return db->getAllBooksForDisplay();
+    }, onFinished);
+}
+
+void DatabaseManager::getFilteredBooksForDisplayAsync(const BookFilterCriteria &criteria, QObject *context, const std::function<void(const QList<BookDisplayInfo> &)> &onFinished)
+{
+    runAsync<QList<BookDisplayInfo>>(context, [criteria](DatabaseManager *db) {
+        return db->getFilteredBooksForDisplay(criteria);
+    }, onFinished);
+}
+
+void DatabaseManager::getBooksPageAsync(const BookFilterCriteria &criteria, const BookPageCursor &cursor, int pageSize, QObject *context, const std::function<void(const BookPage &)> &onFinished)
+{
+    runAsync<BookPage>(context, [criteria, cursor, pageSize](DatabaseManager *db) {
+        return db->getBooksPage(criteria, cursor, pageSize);
+    }, onFinished);
+}
+
+void DatabaseManager::getCatalogSnapshotAsync(QObject *context, const std::function<void(const CatalogSnapshot &)> &onFinished)
+{
+    runAsync<CatalogSnapshot>(context, [](DatabaseManager *db) {
+        return db->getCatalogSnapshot();
+    }, onFinished);
+}
+
+void DatabaseManager::getBooksByGenreAsync(const QString &genre, int limit, QObject *context, const std::function<void(const QList<BookDisplayInfo> &)> &onFinished)
+{
+    runAsync<QList<BookDisplayInfo>>(context, [genre, limit](DatabaseManager *db) {
+        return db->getBooksByGenre(genre, limit);
+    }, onFinished);
+}
+
+void DatabaseManager::getAllAuthorsForDisplayAsync(QObject *context, const std::function<void(const QList<AuthorDisplayInfo> &)> &onFinished)
+{
+    runAsync<QList<AuthorDisplayInfo>>(context, [](DatabaseManager *db) {
+        return db->getAllAuthorsForDisplay();
+    }, onFinished);
+}
+
+void DatabaseManager::getCustomerOrdersForDisplayAsync(int customerId, QObject *context, const std::function<void(const QList<OrderDisplayInfo> &)> &onFinished)
+{
+    runAsync<QList<OrderDisplayInfo>>(context, [customerId](DatabaseManager *db) {
+        return db->getCustomerOrdersForDisplay(customerId);
+    }, onFinished);
+}
+
+void DatabaseManager::getSearchSuggestionsAsync(const QString &prefix, int limit, SearchMode mode, QObject *context, const std::function<void(const QList<SearchSuggestionInfo> &)> &onFinished)
+{
+    runAsync<QList<SearchSuggestionInfo>>(context, [prefix, limit, mode](DatabaseManager *db) {
+        return db->getSearchSuggestions(prefix, limit, mode);
+    }, onFinished);
+}
+
+void DatabaseManager::getSearchIndexEntriesAsync(int afterBookId, int afterAuthorId, QObject *context, const std::function<void(const QList<SearchSuggestionInfo> &)> &onFinished)
+{
+    runAsync<QList<SearchSuggestionInfo>>(context, [afterBookId, afterAuthorId](DatabaseManager *db) {
+        return db->getSearchIndexEntries(afterBookId, afterAuthorId);
+    }, onFinished);
+}
+
+void DatabaseManager::rebuildBookSimilarityAsync(int topK, QObject *context, const std::function<void(bool)> &onFinished)
+{
+    runAsync<bool>(context, [topK](DatabaseManager *db) {
+        return db->rebuildBookSimilarity(topK);
+    }, onFinished);
+}
+
+void DatabaseManager::createOrderAsync(int customerId, const QMap<int, int> &items, const QString &shippingAddress, const QString &paymentMethod,
+                                       QObject *context, const std::function<void(double total, int newOrderId, int loyaltyPointsAwarded)> &onFinished)
+{
+    struct OrderResult {
+        double total = -1.0;
+        int newOrderId = -1;
+        int loyaltyPointsAwarded = 0;
+    };
+    runAsync<OrderResult>(context, [customerId, items, shippingAddress, paymentMethod](DatabaseManager *db) {
+        OrderResult result;
+        result.total = db->createOrder(customerId, items, shippingAddress, paymentMethod, result.newOrderId, &result.loyaltyPointsAwarded);
+        return result;
+    }, [onFinished](const OrderResult &result) {
+        if (onFinished) onFinished(result.total, result.newOrderId, result.loyaltyPointsAwarded);
+    });
+}
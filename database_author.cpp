@@ -1,10 +1,15 @@
 #include "database.h"
+#include "queryresultcache.h"
 #include <QDebug>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QVariant>
 
+namespace {
+constexpr int kAuthorListTtlMs = 5 * 60 * 1000;
+}
+
 QList<AuthorDisplayInfo> DatabaseManager::getAllAuthorsForDisplay() const
 {
     QList<AuthorDisplayInfo> authors;
@@ -13,6 +18,11 @@ QList<AuthorDisplayInfo> DatabaseManager::getAllAuthorsForDisplay() const
         return authors;
     }
 
+    QueryResultCache &cache = QueryResultCache::instance();
+    const QString cacheKey = QueryResultCache::key("GetAllAuthorsForDisplay");
+    if (cache.lookup(cacheKey, &authors)) return authors;
+    const quint64 cacheGeneration = cache.generation();
+
     const QString sql = getSqlQuery("GetAllAuthorsForDisplay");
     if (sql.isEmpty()) return authors;
 
@@ -39,6 +49,7 @@ QList<AuthorDisplayInfo> DatabaseManager::getAllAuthorsForDisplay() const
         count++;
     }
     qInfo() << "Processed" << count << "authors for display.";
+    cache.insert(cacheKey, authors, {QStringLiteral("author")}, kAuthorListTtlMs, count, cacheGeneration);
 
     return authors;
 }
@@ -112,6 +123,8 @@ AuthorDetailsInfo DatabaseManager::getAuthorDetails(int authorId) const
             bookInfo.stockQuantity = booksQuery.value("stock_quantity").toInt();
             bookInfo.authors = booksQuery.value("authors").toString();
             bookInfo.genre = booksQuery.value("genre").toString();
+            bookInfo.ratingSum = booksQuery.value("rating_sum").toInt();
+            bookInfo.ratingCount = booksQuery.value("rating_count").toInt();
             bookInfo.found = true;
 
             if (booksQuery.value("authors").isNull()) {
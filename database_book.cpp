@@ -1,4 +1,6 @@
 #include "database.h"
+#include "catalogsnapshot.h"
+#include "queryresultcache.h"
 #include <QDebug>
 #include <QSqlDatabase>
 #include <QSqlError>
@@ -6,6 +8,15 @@
 #include <QVariant>
 #include <QStringList>
 #include <QDate>
+#include <QMap>
+#include <QSet>
+#include <QtMath>
+
+namespace {
+// TTL кешованих результатів; зміни таблиці book також скидають їх через тег "book"
+constexpr int kGenreListTtlMs = 10 * 60 * 1000;
+constexpr int kBooksByGenreTtlMs = 60 * 1000;
+}
 
 QList<BookDisplayInfo> DatabaseManager::getAllBooksForDisplay() const
 {
@@ -38,6 +49,8 @@ QList<BookDisplayInfo> DatabaseManager::getAllBooksForDisplay() const
         bookInfo.stockQuantity = query.value("stock_quantity").toInt();
         bookInfo.authors = query.value("authors").toString();
         bookInfo.genre = query.value("genre").toString();
+        bookInfo.ratingSum = query.value("rating_sum").toInt();
+        bookInfo.ratingCount = query.value("rating_count").toInt();
         bookInfo.found = true;
 
         if (query.value("authors").isNull()) {
@@ -67,8 +80,67 @@ QList<BookDisplayInfo> DatabaseManager::getFilteredBooksForDisplay(const BookFil
 
     QString sql = sqlBase;
 
-    QStringList whereConditions;
     QMap<QString, QVariant> bindValues;
+    const QStringList whereConditions = buildBookFilterConditions(criteria, bindValues);
+
+    if (!whereConditions.isEmpty()) {
+        sql += "\nWHERE " + whereConditions.join(" AND ");
+    }
+
+    sql += criteria.sortOrder == BookFilterCriteria::SortOrder::Rating
+            ? "\nORDER BY b.rating_avg DESC, b.title;"
+            : "\nORDER BY b.title;";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+
+    for (auto it = bindValues.constBegin(); it != bindValues.constEnd(); ++it) {
+        query.bindValue(it.key(), it.value());
+    }
+
+    qInfo() << "Executing SQL to get filtered books...";
+    qDebug() << "SQL:" << sql;
+    qDebug() << "Bind values:" << bindValues;
+
+    if (!query.exec()) {
+        qCritical() << "Помилка при отриманні відфільтрованого списку книг:";
+        qCritical() << query.lastError().text();
+        qCritical() << "SQL запит:" << query.lastQuery();
+        return books;
+    }
+
+    qInfo() << "Successfully fetched filtered books. Processing results...";
+    int count = 0;
+    while (query.next()) {
+        BookDisplayInfo bookInfo;
+        bookInfo.bookId = query.value("book_id").toInt();
+        bookInfo.title = query.value("title").toString();
+        bookInfo.price = query.value("price").toDouble();
+        bookInfo.coverImagePath = query.value("cover_image_path").toString();
+        bookInfo.stockQuantity = query.value("stock_quantity").toInt();
+        bookInfo.authors = query.value("authors").toString();
+        bookInfo.genre = query.value("genre").toString();
+        bookInfo.ratingSum = query.value("rating_sum").toInt();
+        bookInfo.ratingCount = query.value("rating_count").toInt();
+
+        bookInfo.found = true;
+
+        if (query.value("authors").isNull()) {
+            bookInfo.authors = "";
+        }
+
+        books.append(bookInfo);
+        count++;
+    }
+    qInfo() << "Processed" << count << "filtered books.";
+
+    return books;
+}
+
+// Формує умови WHERE (з аліасом b для таблиці book) та значення для прив'язки за критеріями фільтра
+QStringList DatabaseManager::buildBookFilterConditions(const BookFilterCriteria &criteria, QMap<QString, QVariant> &bindValues)
+{
+    QStringList whereConditions;
 
     if (!criteria.genres.isEmpty()) {
         QStringList genrePlaceholders;
@@ -104,36 +176,68 @@ QList<BookDisplayInfo> DatabaseManager::getFilteredBooksForDisplay(const BookFil
         whereConditions << "b.stock_quantity > 0";
     }
 
-    if (!whereConditions.isEmpty()) {
-        sql += "\nWHERE " + whereConditions.join(" AND ");
+    return whereConditions;
+}
+
+BookPage DatabaseManager::getBooksPage(const BookFilterCriteria &criteria, const BookPageCursor &cursor, int pageSize) const
+{
+    BookPage page;
+    if (!m_isConnected || !m_db.isOpen()) {
+        qWarning() << "Неможливо отримати сторінку книг: немає активного з'єднання з БД.";
+        return page;
     }
+    if (pageSize <= 0) pageSize = 60;
 
-    sql += R"(
-        GROUP BY b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre, b.language, p.name
-        ORDER BY b.title;
-    )";
+    const QString sqlBase = getSqlQuery("GetBooksPageBase");
+    if (sqlBase.isEmpty()) return page;
 
-    QSqlQuery query(m_db);
-    query.prepare(sql);
+    QMap<QString, QVariant> bindValues;
+    QStringList whereConditions = buildBookFilterConditions(criteria, bindValues);
+
+    const bool byRating = criteria.sortOrder == BookFilterCriteria::SortOrder::Rating;
+    if (!cursor.isStart()) {
+        // Умова курсора використовує індекс (title, book_id) або (rating_avg DESC, book_id)
+        // і не залежить від глибини прокрутки
+        if (byRating) {
+            whereConditions << "(b.rating_avg < CAST(:afterRating AS NUMERIC)"
+                               " OR (b.rating_avg = CAST(:afterRating AS NUMERIC) AND b.book_id > :afterBookId))";
+            bindValues[":afterRating"] = cursor.afterRating;
+        } else {
+            whereConditions << "(b.title, b.book_id) > (:afterTitle, :afterBookId)";
+            bindValues[":afterTitle"] = cursor.afterTitle;
+        }
+        bindValues[":afterBookId"] = cursor.afterBookId;
+    }
+    // Беремо на один рядок більше, щоб знати, чи є наступна сторінка
+    bindValues[":pageLimit"] = pageSize + 1;
+
+    const QString sql = sqlBase.arg(whereConditions.isEmpty() ? QString() : "WHERE " + whereConditions.join(" AND "),
+                                    byRating ? "b.rating_avg DESC, b.book_id" : "b.title, b.book_id");
 
+    QSqlQuery query(m_db);
+    if (!query.prepare(sql)) {
+        qCritical() << "Помилка підготовки запиту 'GetBooksPageBase':" << query.lastError().text();
+        return page;
+    }
     for (auto it = bindValues.constBegin(); it != bindValues.constEnd(); ++it) {
         query.bindValue(it.key(), it.value());
     }
 
-    qInfo() << "Executing SQL to get filtered books...";
-    qDebug() << "SQL:" << sql;
-    qDebug() << "Bind values:" << bindValues;
-
+    qInfo() << "Executing SQL 'GetBooksPageBase' after book ID:" << cursor.afterBookId << "page size:" << pageSize;
     if (!query.exec()) {
-        qCritical() << "Помилка при отриманні відфільтрованого списку книг:";
+        qCritical() << "Помилка при виконанні 'GetBooksPageBase':";
         qCritical() << query.lastError().text();
         qCritical() << "SQL запит:" << query.lastQuery();
-        return books;
+        qCritical() << "Bind values:" << bindValues;
+        return page;
     }
 
-    qInfo() << "Successfully fetched filtered books. Processing results...";
-    int count = 0;
+    QString lastRatingAvg;
     while (query.next()) {
+        if (page.books.size() == pageSize) {
+            page.hasMore = true;
+            break;
+        }
         BookDisplayInfo bookInfo;
         bookInfo.bookId = query.value("book_id").toInt();
         bookInfo.title = query.value("title").toString();
@@ -142,19 +246,64 @@ QList<BookDisplayInfo> DatabaseManager::getFilteredBooksForDisplay(const BookFil
         bookInfo.stockQuantity = query.value("stock_quantity").toInt();
         bookInfo.authors = query.value("authors").toString();
         bookInfo.genre = query.value("genre").toString();
-
+        bookInfo.ratingSum = query.value("rating_sum").toInt();
+        bookInfo.ratingCount = query.value("rating_count").toInt();
         bookInfo.found = true;
 
         if (query.value("authors").isNull()) {
             bookInfo.authors = "";
         }
 
-        books.append(bookInfo);
-        count++;
+        page.books.append(bookInfo);
+        lastRatingAvg = query.value("rating_avg").toString();
     }
-    qInfo() << "Processed" << count << "filtered books.";
 
-    return books;
+    if (!page.books.isEmpty()) {
+        page.nextCursor.afterTitle = page.books.last().title;
+        page.nextCursor.afterRating = lastRatingAvg;
+        page.nextCursor.afterBookId = page.books.last().bookId;
+    }
+    qInfo() << "Processed page of" << page.books.size() << "books, has more:" << page.hasMore;
+
+    return page;
+}
+
+CatalogSnapshot DatabaseManager::getCatalogSnapshot() const
+{
+    CatalogSnapshot snapshot;
+    if (!m_isConnected || !m_db.isOpen()) {
+        qWarning() << "Неможливо завантажити знімок каталогу: немає активного з'єднання з БД.";
+        return snapshot;
+    }
+
+    QSqlQuery *cachedQuery = preparedQuery("GetCatalogSnapshot");
+    if (!cachedQuery) return snapshot;
+    QSqlQuery &query = *cachedQuery;
+
+    qInfo() << "Executing SQL 'GetCatalogSnapshot'...";
+    if (!query.exec()) {
+        qCritical() << "Помилка при виконанні 'GetCatalogSnapshot':" << query.lastError().text();
+        return snapshot;
+    }
+
+    while (query.next()) {
+        BookDisplayInfo bookInfo;
+        bookInfo.bookId = query.value("book_id").toInt();
+        bookInfo.title = query.value("title").toString();
+        bookInfo.price = query.value("price").isNull() ? qQNaN() : query.value("price").toDouble();
+        bookInfo.coverImagePath = query.value("cover_image_path").toString();
+        bookInfo.stockQuantity = query.value("stock_quantity").toInt();
+        bookInfo.authors = query.value("authors").toString();
+        bookInfo.genre = query.value("genre").toString();
+        bookInfo.ratingSum = query.value("rating_sum").toInt();
+        bookInfo.ratingCount = query.value("rating_count").toInt();
+        const int ratingAvgCents = qRound(query.value("rating_avg").toDouble() * 100.0);
+        snapshot.appendBook(bookInfo, query.value("language").toString(), ratingAvgCents);
+    }
+    snapshot.finalize();
+    qInfo() << "Catalog snapshot loaded:" << snapshot.size() << "books";
+
+    return snapshot;
 }
 
 QStringList DatabaseManager::getAllGenres() const
@@ -165,6 +314,11 @@ QStringList DatabaseManager::getAllGenres() const
         return genres;
     }
 
+    QueryResultCache &cache = QueryResultCache::instance();
+    const QString cacheKey = QueryResultCache::key("GetAllDistinctGenres");
+    if (cache.lookup(cacheKey, &genres)) return genres;
+    const quint64 cacheGeneration = cache.generation();
+
     const QString sql = getSqlQuery("GetAllDistinctGenres");
     if (sql.isEmpty()) return genres;
 
@@ -181,6 +335,7 @@ QStringList DatabaseManager::getAllGenres() const
         genres.append(query.value(0).toString());
     }
     qInfo() << "Fetched" << genres.size() << "distinct genres.";
+    cache.insert(cacheKey, genres, {QStringLiteral("book")}, kGenreListTtlMs, genres.size(), cacheGeneration);
     return genres;
 }
 
@@ -192,6 +347,11 @@ QStringList DatabaseManager::getAllLanguages() const
         return languages;
     }
 
+    QueryResultCache &cache = QueryResultCache::instance();
+    const QString cacheKey = QueryResultCache::key("GetAllDistinctLanguages");
+    if (cache.lookup(cacheKey, &languages)) return languages;
+    const quint64 cacheGeneration = cache.generation();
+
     const QString sql = getSqlQuery("GetAllDistinctLanguages");
     if (sql.isEmpty()) return languages;
 
@@ -208,6 +368,7 @@ QStringList DatabaseManager::getAllLanguages() const
         languages.append(query.value(0).toString());
     }
     qInfo() << "Fetched" << languages.size() << "distinct languages.";
+    cache.insert(cacheKey, languages, {QStringLiteral("book")}, kGenreListTtlMs, languages.size(), cacheGeneration);
     return languages;
 }
 
@@ -220,14 +381,9 @@ BookDetailsInfo DatabaseManager::getBookDetails(int bookId) const
         return details;
     }
 
-    const QString sql = getSqlQuery("GetBookDetailsById");
-    if (sql.isEmpty()) return details;
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'GetBookDetailsById':" << query.lastError().text();
-        return details;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("GetBookDetailsById");
+    if (!cachedQuery) return details;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":bookId", bookId);
 
     qInfo() << "Executing SQL 'GetBookDetailsById' for book ID:" << bookId;
@@ -279,14 +435,9 @@ BookDisplayInfo DatabaseManager::getBookDisplayInfoById(int bookId) const
         return bookInfo;
     }
 
-    const QString sql = getSqlQuery("GetBookDisplayInfoById");
-    if (sql.isEmpty()) return bookInfo;
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'GetBookDisplayInfoById':" << query.lastError().text();
-        return bookInfo;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("GetBookDisplayInfoById");
+    if (!cachedQuery) return bookInfo;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":bookId", bookId);
 
     qInfo() << "Executing SQL 'GetBookDisplayInfoById' for book ID:" << bookId;
@@ -305,6 +456,8 @@ BookDisplayInfo DatabaseManager::getBookDisplayInfoById(int bookId) const
         bookInfo.stockQuantity = query.value("stock_quantity").toInt();
         bookInfo.authors = query.value("authors").toString();
         bookInfo.genre = query.value("genre").toString();
+        bookInfo.ratingSum = query.value("rating_sum").toInt();
+        bookInfo.ratingCount = query.value("rating_count").toInt();
         if (query.value("authors").isNull()) {
             bookInfo.authors = "";
         }
@@ -329,16 +482,17 @@ QList<BookDisplayInfo> DatabaseManager::getBooksByGenre(const QString &genre, in
         return books;
     }
 
-    const QString sql = getSqlQuery("GetBooksByGenre");
-    if (sql.isEmpty()) return books;
+    const int effectiveLimit = limit > 0 ? limit : 10;
+    QueryResultCache &cache = QueryResultCache::instance();
+    const QString cacheKey = QueryResultCache::key("GetBooksByGenre", {genre, effectiveLimit});
+    if (cache.lookup(cacheKey, &books)) return books;
+    const quint64 cacheGeneration = cache.generation();
 
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'GetBooksByGenre':" << query.lastError().text();
-        return books;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("GetBooksByGenre");
+    if (!cachedQuery) return books;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":genre", genre);
-    query.bindValue(":limit", limit > 0 ? limit : 10);
+    query.bindValue(":limit", effectiveLimit);
 
     qInfo() << "Executing SQL 'GetBooksByGenre' for genre:" << genre << "with limit:" << query.boundValue(":limit").toInt();
     if (!query.exec()) {
@@ -360,6 +514,8 @@ QList<BookDisplayInfo> DatabaseManager::getBooksByGenre(const QString &genre, in
         bookInfo.stockQuantity = query.value("stock_quantity").toInt();
         bookInfo.authors = query.value("authors").toString();
         bookInfo.genre = query.value("genre").toString();
+        bookInfo.ratingSum = query.value("rating_sum").toInt();
+        bookInfo.ratingCount = query.value("rating_count").toInt();
         bookInfo.found = true;
 
         if (query.value("authors").isNull()) {
@@ -370,11 +526,12 @@ QList<BookDisplayInfo> DatabaseManager::getBooksByGenre(const QString &genre, in
         count++;
     }
     qInfo() << "Processed" << count << "books for genre" << genre;
+    cache.insert(cacheKey, books, {QStringLiteral("book")}, kBooksByGenreTtlMs, count, cacheGeneration);
 
     return books;
 }
 
-QList<SearchSuggestionInfo> DatabaseManager::getSearchSuggestions(const QString &prefix, int limit) const
+QList<SearchSuggestionInfo> DatabaseManager::getSearchSuggestions(const QString &prefix, int limit, SearchMode mode) const
 {
     QList<SearchSuggestionInfo> suggestions;
 
@@ -383,20 +540,17 @@ QList<SearchSuggestionInfo> DatabaseManager::getSearchSuggestions(const QString
         return suggestions;
     }
 
-    const QString sql = getSqlQuery("GetSearchSuggestions");
-    if (sql.isEmpty()) return suggestions;
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'GetSearchSuggestions':" << query.lastError().text();
-        return suggestions;
-    }
-    query.bindValue(":prefix", prefix);
+    const bool fuzzy = mode == SearchMode::Fuzzy;
+    const QString queryName = fuzzy ? "GetFuzzySearchSuggestions" : "GetSearchSuggestions";
+    QSqlQuery *cachedQuery = preparedQuery(queryName);
+    if (!cachedQuery) return suggestions;
+    QSqlQuery &query = *cachedQuery;
+    query.bindValue(fuzzy ? ":query" : ":prefix", prefix);
     query.bindValue(":total_limit", limit > 0 ? limit : 10);
 
-    qInfo() << "Executing SQL 'GetSearchSuggestions' for prefix:" << prefix << "with limit:" << query.boundValue(":total_limit").toInt();
+    qInfo() << "Executing SQL" << queryName << "for prefix:" << prefix << "with limit:" << query.boundValue(":total_limit").toInt();
     if (!query.exec()) {
-        qCritical() << "Помилка при виконанні 'GetSearchSuggestions' для префікса '" << prefix << "':";
+        qCritical() << "Помилка при виконанні" << queryName << "для префікса '" << prefix << "':";
         qCritical() << query.lastError().text();
         qCritical() << "SQL запит:" << query.lastQuery();
         qCritical() << "Bound values:" << query.boundValues();
@@ -430,56 +584,165 @@ QList<SearchSuggestionInfo> DatabaseManager::getSearchSuggestions(const QString
     return suggestions;
 }
 
-QList<BookDisplayInfo> DatabaseManager::getSimilarBooks(int currentBookId, const QString &genre, int limit) const
+bool DatabaseManager::isFuzzySearchAvailable() const
 {
-    QList<BookDisplayInfo> books;
-    if (!m_isConnected || !m_db.isOpen() || genre.isEmpty() || currentBookId <= 0) {
-        qWarning() << "Неможливо отримати схожі книги: немає з'єднання, порожній жанр або невірний currentBookId.";
-        return books;
+    if (!m_isConnected || !m_db.isOpen()) {
+        return false;
     }
 
-    const QString sql = getSqlQuery("GetSimilarBooksByGenre");
-    if (sql.isEmpty()) return books;
+    QSqlQuery *cachedQuery = preparedQuery("CheckFuzzySearchAvailable");
+    if (!cachedQuery) return false;
+    QSqlQuery &query = *cachedQuery;
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Не вдалося перевірити наявність pg_trgm:" << query.lastError().text();
+        return false;
+    }
+    return query.value("available").toBool();
+}
 
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'GetSimilarBooksByGenre':" << query.lastError().text();
-        return books;
+QList<SearchSuggestionInfo> DatabaseManager::getSearchIndexEntries(int afterBookId, int afterAuthorId) const
+{
+    QList<SearchSuggestionInfo> entries;
+
+    if (!m_isConnected || !m_db.isOpen()) {
+        return entries;
     }
-    query.bindValue(":genre", genre);
-    query.bindValue(":currentBookId", currentBookId);
-    query.bindValue(":limit", limit > 0 ? limit : 5);
 
-    qInfo() << "Executing SQL 'GetSimilarBooksByGenre' for genre:" << genre << "excluding book ID:" << currentBookId << "with limit:" << query.boundValue(":limit").toInt();
+    QSqlQuery *cachedQuery = preparedQuery("GetSearchIndexEntries");
+    if (!cachedQuery) return entries;
+    QSqlQuery &query = *cachedQuery;
+    query.bindValue(":afterBookId", afterBookId);
+    query.bindValue(":afterAuthorId", afterAuthorId);
+
     if (!query.exec()) {
-        qCritical() << "Помилка при виконанні 'GetSimilarBooksByGenre' для жанру '" << genre << "':";
+        qCritical() << "Помилка при виконанні 'GetSearchIndexEntries':";
         qCritical() << query.lastError().text();
-        qCritical() << "SQL запит:" << query.lastQuery();
-        qCritical() << "Bound values:" << query.boundValues();
-        return books;
+        return entries;
     }
 
-    qInfo() << "Successfully fetched similar books for genre" << genre << ". Processing results...";
-    int count = 0;
     while (query.next()) {
-        BookDisplayInfo bookInfo;
-        bookInfo.bookId = query.value("book_id").toInt();
-        bookInfo.title = query.value("title").toString();
-        bookInfo.price = query.value("price").toDouble();
-        bookInfo.coverImagePath = query.value("cover_image_path").toString();
-        bookInfo.stockQuantity = query.value("stock_quantity").toInt();
-        bookInfo.authors = query.value("authors").toString();
-        bookInfo.genre = query.value("genre").toString();
-        bookInfo.found = true;
+        SearchSuggestionInfo entry;
+        const QString typeStr = query.value("type").toString();
+        entry.type = typeStr == "author" ? SearchSuggestionInfo::Author : SearchSuggestionInfo::Book;
+        entry.id = query.value("id").toInt();
+        entry.displayText = query.value("display_text").toString();
+        entry.imagePath = query.value("image_path").toString();
+        entry.price = query.value("price").toDouble();
+        entries.append(entry);
+    }
+    qInfo() << "Loaded" << entries.size() << "search index entries (after book" << afterBookId << ", author" << afterAuthorId << ")";
+
+    return entries;
+}
 
-        if (query.value("authors").isNull()) {
-            bookInfo.authors = "";
+QList<BookDisplayInfo> DatabaseManager::getSimilarBooks(int currentBookId, const QString &genre, int limit) const
+{
+    QList<BookDisplayInfo> books;
+    if (!m_isConnected || !m_db.isOpen() || currentBookId <= 0) {
+        qWarning() << "Неможливо отримати схожі книги: немає з'єднання або невірний currentBookId.";
+        return books;
+    }
+    if (limit <= 0) limit = 5;
+
+    QSet<int> seenIds;
+    seenIds.insert(currentBookId);
+    auto readBooks = [&books, &seenIds, limit](QSqlQuery &query) {
+        while (query.next() && books.size() < limit) {
+            const int bookId = query.value("book_id").toInt();
+            if (seenIds.contains(bookId)) continue;
+            seenIds.insert(bookId);
+
+            BookDisplayInfo bookInfo;
+            bookInfo.bookId = bookId;
+            bookInfo.title = query.value("title").toString();
+            bookInfo.price = query.value("price").toDouble();
+            bookInfo.coverImagePath = query.value("cover_image_path").toString();
+            bookInfo.stockQuantity = query.value("stock_quantity").toInt();
+            bookInfo.authors = query.value("authors").isNull() ? QString() : query.value("authors").toString();
+            bookInfo.genre = query.value("genre").toString();
+            bookInfo.ratingSum = query.value("rating_sum").toInt();
+            bookInfo.ratingCount = query.value("rating_count").toInt();
+            bookInfo.found = true;
+            books.append(bookInfo);
         }
-
-        books.append(bookInfo);
-        count++;
+    };
+
+    // 1. Попередньо обчислені сусіди за спільними покупками (book_similarity)
+    if (QSqlQuery *similarityQuery = preparedQuery("GetSimilarBooksFromSimilarity")) {
+        similarityQuery->bindValue(":bookId", currentBookId);
+        similarityQuery->bindValue(":limit", limit);
+        if (similarityQuery->exec()) {
+            readBooks(*similarityQuery);
+        } else {
+            qWarning() << "Помилка при виконанні 'GetSimilarBooksFromSimilarity' для книги" << currentBookId << ":" << similarityQuery->lastError().text();
+        }
+    }
+    const int fromSimilarity = books.size();
+
+    // 2. Якщо покупок замало — доповнюємо випадковими книгами того ж жанру
+    if (books.size() < limit && !genre.isEmpty()) {
+        QSqlQuery *cachedQuery = preparedQuery("GetSimilarBooksByGenre");
+        if (!cachedQuery) return books;
+        QSqlQuery &query = *cachedQuery;
+        query.bindValue(":genre", genre);
+        query.bindValue(":currentBookId", currentBookId);
+        query.bindValue(":limit", limit + fromSimilarity); // Запас на книги, які вже є серед рекомендацій
+
+        if (!query.exec()) {
+            qCritical() << "Помилка при виконанні 'GetSimilarBooksByGenre' для жанру '" << genre << "':";
+            qCritical() << query.lastError().text();
+            qCritical() << "SQL запит:" << query.lastQuery();
+            qCritical() << "Bound values:" << query.boundValues();
+            return books;
+        }
+        readBooks(query);
     }
-    qInfo() << "Processed" << count << "similar books for genre" << genre;
 
+    qInfo() << "Similar books for" << currentBookId << ":" << fromSimilarity << "from co-purchases,"
+            << books.size() - fromSimilarity << "from genre" << genre;
     return books;
 }
+
+// Пакетний перерахунок book_similarity з order_item. Виконується в одній транзакції:
+// до коміту читачі бачать попередній набір рекомендацій.
+bool DatabaseManager::rebuildBookSimilarity(int topK)
+{
+    if (!m_isConnected || !m_db.isOpen()) {
+        qWarning() << "rebuildBookSimilarity: немає активного з'єднання з БД.";
+        return false;
+    }
+    if (topK <= 0) topK = 10;
+
+    if (!m_db.transaction()) {
+        qCritical() << "rebuildBookSimilarity: не вдалося почати транзакцію:" << m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_db);
+    bool success = executeQuery(query, getSqlQuery("TryLockBookSimilarityRebuild"), "Блокування перерахунку book_similarity");
+    if (success && !(query.next() && query.value("acquired").toBool())) {
+        // Інший клієнт уже перераховує: його DELETE/INSERT конфліктували б з нашими (23505)
+        qInfo() << "rebuildBookSimilarity: перерахунок уже виконує інший клієнт, пропускаємо.";
+        m_db.rollback();
+        return true;
+    }
+    if (success) {
+        success = executeQuery(query, getSqlQuery("DeleteBookSimilarity"), "Очищення book_similarity");
+    }
+    if (success) {
+        query.prepare(getSqlQuery("RebuildBookSimilarity"));
+        query.bindValue(":topK", topK);
+        success = query.exec();
+        if (!success) {
+            qCritical() << "Помилка перерахунку book_similarity:" << query.lastError().text();
+        }
+    }
+
+    if (success && m_db.commit()) {
+        qInfo() << "book_similarity перераховано: top" << topK << ", рядків:" << query.numRowsAffected();
+        return true;
+    }
+    qCritical() << "rebuildBookSimilarity: відкат транзакції:" << m_db.lastError().text();
+    m_db.rollback();
+    return false;
+}
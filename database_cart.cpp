@@ -15,14 +15,9 @@ QMap<int, int> DatabaseManager::getCartItems(int customerId) const
         return cartItems; // Повертаємо порожню мапу
     }
 
-    const QString sql = getSqlQuery("GetCartItemsByCustomerId");
-    if (sql.isEmpty()) return cartItems; // Помилка завантаження запиту
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'GetCartItemsByCustomerId':" << query.lastError().text();
-        return cartItems;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("GetCartItemsByCustomerId");
+    if (!cachedQuery) return cartItems;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":customerId", customerId);
 
     qInfo() << "Executing SQL 'GetCartItemsByCustomerId' for customer ID:" << customerId;
@@ -56,16 +51,10 @@ bool DatabaseManager::addOrUpdateCartItem(int customerId, int bookId, int quanti
         return removeCartItem(customerId, bookId); // Якщо кількість 0 або менше, видаляємо товар
     }
 
-    QSqlQuery query(m_db);
-    // Використовуємо завантажений SQL запит
-    const QString sql = getSqlQuery("AddOrUpdateCartItem");
-     if (sql.isEmpty()) return false; // Помилка завантаження запиту
-
-    // QSqlQuery query(m_db); // Видаляємо повторне оголошення
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'AddOrUpdateCartItem':" << query.lastError().text();
-        return false;
-    }
+    // Використовуємо підготовлений запит з кешу (викликається на кожну зміну кількості)
+    QSqlQuery *cachedQuery = preparedQuery("AddOrUpdateCartItem");
+    if (!cachedQuery) return false;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":customerId", customerId);
     query.bindValue(":bookId", bookId);
     query.bindValue(":quantity", quantity);
@@ -81,21 +70,56 @@ bool DatabaseManager::addOrUpdateCartItem(int customerId, int bookId, int quanti
     return true;
 }
 
-bool DatabaseManager::removeCartItem(int customerId, int bookId)
+// Записує набір абсолютних кількостей (bookId -> quantity, 0 = видалити) одним запитом
+bool DatabaseManager::applyCartChanges(int customerId, const QMap<int, int> &changes)
 {
     if (!m_isConnected || !m_db.isOpen()) {
-        qWarning() << "removeCartItem: Немає активного з'єднання з БД.";
+        qWarning() << "applyCartChanges: Немає активного з'єднання з БД.";
         return false;
     }
+    if (changes.isEmpty()) {
+        return true;
+    }
 
-    const QString sql = getSqlQuery("RemoveCartItem");
-    if (sql.isEmpty()) return false; // Помилка завантаження запиту
+    QList<int> bookIds;
+    QList<int> quantities;
+    QList<int> removedBookIds;
+    for (auto it = changes.constBegin(); it != changes.constEnd(); ++it) {
+        if (it.value() > 0) {
+            bookIds.append(it.key());
+            quantities.append(it.value());
+        } else {
+            removedBookIds.append(it.key());
+        }
+    }
 
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'RemoveCartItem':" << query.lastError().text();
+    QSqlQuery *cachedQuery = preparedQuery("ApplyCartChanges");
+    if (!cachedQuery) return false;
+    QSqlQuery &query = *cachedQuery;
+    query.bindValue(":customerId", customerId);
+    query.bindValue(":removedBookIds", toPostgresIntArray(removedBookIds));
+    query.bindValue(":bookIds", toPostgresIntArray(bookIds));
+    query.bindValue(":quantities", toPostgresIntArray(quantities));
+
+    qInfo() << "Executing SQL 'ApplyCartChanges' for customer ID:" << customerId
+            << "upserts:" << bookIds.size() << "removals:" << removedBookIds.size();
+    if (!query.exec()) {
+        qCritical() << "Помилка при виконанні 'ApplyCartChanges' для customerId" << customerId << ":" << query.lastError().text();
         return false;
     }
+    return true;
+}
+
+bool DatabaseManager::removeCartItem(int customerId, int bookId)
+{
+    if (!m_isConnected || !m_db.isOpen()) {
+        qWarning() << "removeCartItem: Немає активного з'єднання з БД.";
+        return false;
+    }
+
+    QSqlQuery *cachedQuery = preparedQuery("RemoveCartItem");
+    if (!cachedQuery) return false;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":customerId", customerId);
     query.bindValue(":bookId", bookId);
 
@@ -120,14 +144,9 @@ bool DatabaseManager::clearCart(int customerId)
         return false;
     }
 
-    const QString sql = getSqlQuery("ClearCartByCustomerId");
-    if (sql.isEmpty()) return false; // Помилка завантаження запиту
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'ClearCartByCustomerId':" << query.lastError().text();
-        return false;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("ClearCartByCustomerId");
+    if (!cachedQuery) return false;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":customerId", customerId);
 
     qInfo() << "Executing SQL 'ClearCartByCustomerId' for customer ID:" << customerId;
@@ -1,4 +1,5 @@
 #include "database.h"
+#include "queryresultcache.h"
 #include <QDebug>
 #include <QSqlDatabase>
 #include <QSqlError>
@@ -14,14 +15,9 @@ bool DatabaseManager::hasUserCommentedOnBook(int bookId, int customerId) const
         return false; // Повертаємо false, щоб уникнути блокування, якщо є проблема з перевіркою
     }
 
-    const QString sql = getSqlQuery("CheckUserCommentExists");
-    if (sql.isEmpty()) return false; // Помилка завантаження запиту
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'CheckUserCommentExists':" << query.lastError().text();
-        return false;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("CheckUserCommentExists");
+    if (!cachedQuery) return false;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":bookId", bookId);
     query.bindValue(":customerId", customerId);
 
@@ -61,14 +57,9 @@ bool DatabaseManager::addComment(int bookId, int customerId, const QString &comm
         return false;
     }
 
-    const QString sql = getSqlQuery("AddComment");
-    if (sql.isEmpty()) return false; // Помилка завантаження запиту
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'AddComment':" << query.lastError().text();
-        return false;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("AddComment");
+    if (!cachedQuery) return false;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":book_id", bookId);
     query.bindValue(":customer_id", customerId);
     query.bindValue(":comment_text", commentText.trimmed());
@@ -85,6 +76,9 @@ bool DatabaseManager::addComment(int bookId, int customerId, const QString &comm
     }
 
     qInfo() << "Comment added successfully for book ID:" << bookId;
+    if (rating > 0) {
+        QueryResultCache::instance().invalidateTag(QStringLiteral("book")); // Змінився рейтинг книги
+    }
     return true;
 }
 
@@ -97,14 +91,9 @@ QList<CommentDisplayInfo> DatabaseManager::getBookComments(int bookId) const
         return comments;
     }
 
-    const QString sql = getSqlQuery("GetBookCommentsByBookId");
-    if (sql.isEmpty()) return comments; // Помилка завантаження запиту
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'GetBookCommentsByBookId':" << query.lastError().text();
-        return comments;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("GetBookCommentsByBookId");
+    if (!cachedQuery) return comments;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":bookId", bookId);
 
     qInfo() << "Executing SQL 'GetBookCommentsByBookId' for book ID:" << bookId;
@@ -119,6 +108,7 @@ QList<CommentDisplayInfo> DatabaseManager::getBookComments(int bookId) const
     int count = 0;
     while (query.next()) {
         CommentDisplayInfo commentInfo;
+        commentInfo.commentId = query.value("comment_id").toInt();
         commentInfo.authorName = query.value("author_name").toString();
         commentInfo.commentDate = query.value("comment_date").toDateTime();
         // Обробка NULL для рейтингу
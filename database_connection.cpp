@@ -1,4 +1,5 @@
 #include "database.h"
+#include "queryresultcache.h"
 #include <QDebug>
 #include <QSqlDatabase>
 #include <QSqlError>
@@ -7,11 +8,15 @@
 #include <QVector>
 #include <QDate>
 #include <QDateTime>
+#include <QAtomicInt>
 #include <QSqlRecord> // Needed for query.record()
 #include <QMap>       // Потрібен для QMap в інших файлах
 #include <QFile>      // Для читання файлів SQL
 #include <QTextStream>// Для читання файлів SQL
 #include <QDir>       // Для роботи з директоріями SQL
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QRegularExpression>
 
 // Конструктор і деструктор
 DatabaseManager::DatabaseManager(QObject *parent) : QObject(parent), m_isConnected(false) // Ініціалізуємо m_isConnected
@@ -43,7 +48,9 @@ bool DatabaseManager::connectToDatabase(const QString &host,
 {
     closeConnection(); // Закриваємо попереднє з'єднання, якщо воно було
     // Використовуємо унікальне ім'я з'єднання, щоб уникнути конфліктів
-    const QString connectionName = QString("db_connection_%1").arg(QDateTime::currentMSecsSinceEpoch());
+    // (лічильник потрібен, бо фонові потоки можуть підключатися в ту саму мілісекунду)
+    static QAtomicInt connectionCounter;
+    const QString connectionName = QString("db_connection_%1_%2").arg(QDateTime::currentMSecsSinceEpoch()).arg(connectionCounter.fetchAndAddRelaxed(1));
     m_db = QSqlDatabase::addDatabase("QPSQL", connectionName);
     m_db.setHostName(host);
     m_db.setPort(port);
@@ -61,6 +68,14 @@ bool DatabaseManager::connectToDatabase(const QString &host,
 
     qDebug() << "Успішно підключено до бази даних" << dbName << "на" << host << ":" << port << "З'єднання:" << connectionName;
     m_isConnected = true;
+    m_ownsConnection = true;
+
+    // Запам'ятовуємо параметри, щоб фонові потоки могли відкрити власні з'єднання
+    m_connectionConfig.host = host;
+    m_connectionConfig.port = port;
+    m_connectionConfig.dbName = dbName;
+    m_connectionConfig.user = user;
+    m_connectionConfig.password = password;
     return true;
 }
 
@@ -78,6 +93,9 @@ bool DatabaseManager::createSchemaTables()
         return false;
     }
     qInfo() << "Транзакция начата для создания схемы...";
+    // Таблиці перестворюються — підготовлені плани та кешовані результати більше не дійсні
+    clearPreparedQueries();
+    QueryResultCache::instance().clear();
 
     QSqlQuery query(m_db);
     bool success = true;
@@ -85,7 +103,8 @@ bool DatabaseManager::createSchemaTables()
     // --- SQL Запити для створення таблиць (порядок важен!) ---
     // 1. Видалення існуючих таблиць (якщо потрібно почати з чистого аркуша)
     // Використовуємо getSqlQuery для отримання запитів з файлу
-    success &= executeQuery(query, getSqlQuery("DropOrderStatusTable"), "Видалення order_status");
+    success &= executeQuery(query, getSqlQuery("DropBookSimilarityTable"), "Видалення book_similarity");
+    if(success) success &= executeQuery(query, getSqlQuery("DropOrderStatusTable"), "Видалення order_status");
     if(success) success &= executeQuery(query, getSqlQuery("DropOrderItemTable"),   "Видалення order_item");
     if(success) success &= executeQuery(query, getSqlQuery("DropCommentTable"),     "Видалення comment");
     if(success) success &= executeQuery(query, getSqlQuery("DropBookAuthorTable"),  "Видалення book_author");
@@ -107,18 +126,23 @@ bool DatabaseManager::createSchemaTables()
     if(success) success &= executeQuery(query, getSqlQuery("CreateOrderStatusTable"), "Створення order_status");
     if(success) success &= executeQuery(query, getSqlQuery("CreateCommentTable"), "Створення comment");
     if(success) success &= executeQuery(query, getSqlQuery("CreateCartItemTable"), "Створення cart_item");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateBookSimilarityTable"), "Створення book_similarity");
 
-    // 3. Створення функцій
+    // 3. Створення функцій та тригерів
     if(success) success &= executeQuery(query, getSqlQuery("CreateCalculateAverageRatingFunction"), "Створення функції calculate_average_book_rating");
+    if(success) success &= createBookAuthorsTextObjects(query);
+    if(success) success &= createBookRatingObjects(query);
+    if(success) success &= createChangeNotificationObjects(query);
 
-    // 4. Добавление комментариев и индексов (опционально)
-    // ... (код для комментариев и индексов) ...
+    // 4. Вторинні індекси (керований набір з sql/indexes.sql)
+    if(success) success &= createManagedIndexes(query);
 
 
     // Завершаем транзакцию
     if (success) {
         if (m_db.commit()) {
             qInfo() << "Транзакция создания схемы успешно завершена.";
+            createSearchExtensions(); // Не критично: без pg_trgm працює пошук за префіксом
             return true;
         } else {
             qCritical() << "Ошибка при коммите транзакции создания схемы:" << m_db.lastError().text();
@@ -136,6 +160,255 @@ bool DatabaseManager::createSchemaTables()
     }
 }
 
+// Функції та тригери, що підтримують денормалізований book.authors_text
+bool DatabaseManager::createBookAuthorsTextObjects(QSqlQuery &query)
+{
+    bool success = executeQuery(query, getSqlQuery("CreateRefreshBookAuthorsTextFunction"), "Створення функції refresh_book_authors_text");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateBookAuthorAuthorsTextTriggerFunction"), "Створення тригерної функції book_author_refresh_authors_text");
+    if(success) success &= executeQuery(query, getSqlQuery("DropBookAuthorAuthorsTextTrigger"), "Видалення тригера trg_book_author_authors_text");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateBookAuthorAuthorsTextTrigger"), "Створення тригера trg_book_author_authors_text");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateAuthorAuthorsTextTriggerFunction"), "Створення тригерної функції author_refresh_authors_text");
+    if(success) success &= executeQuery(query, getSqlQuery("DropAuthorAuthorsTextTrigger"), "Видалення тригера trg_author_authors_text");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateAuthorAuthorsTextTrigger"), "Створення тригера trg_author_authors_text");
+    return success;
+}
+
+// Тригер, що підтримує book.rating_sum / rating_count при змінах у comment
+bool DatabaseManager::createBookRatingObjects(QSqlQuery &query)
+{
+    bool success = executeQuery(query, getSqlQuery("CreateCommentRatingTriggerFunction"), "Створення тригерної функції comment_update_book_rating");
+    if(success) success &= executeQuery(query, getSqlQuery("DropCommentRatingTrigger"), "Видалення тригера trg_comment_book_rating");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateCommentRatingTrigger"), "Створення тригера trg_comment_book_rating");
+    return success;
+}
+
+// Тригери, що надсилають pg_notify('bookstore_changes', ...) при змінах book/author/comment/order_status/cart_item
+bool DatabaseManager::createChangeNotificationObjects(QSqlQuery &query)
+{
+    bool success = executeQuery(query, getSqlQuery("CreateNotifyBookstoreChangeFunction"), "Створення тригерної функції notify_bookstore_change");
+    if(success) success &= executeQuery(query, getSqlQuery("DropBookNotifyTrigger"), "Видалення тригера trg_book_notify_change");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateBookNotifyTrigger"), "Створення тригера trg_book_notify_change");
+    if(success) success &= executeQuery(query, getSqlQuery("DropAuthorNotifyTrigger"), "Видалення тригера trg_author_notify_change");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateAuthorNotifyTrigger"), "Створення тригера trg_author_notify_change");
+    if(success) success &= executeQuery(query, getSqlQuery("DropCommentNotifyTrigger"), "Видалення тригера trg_comment_notify_change");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateCommentNotifyTrigger"), "Створення тригера trg_comment_notify_change");
+    if(success) success &= executeQuery(query, getSqlQuery("DropOrderStatusNotifyTrigger"), "Видалення тригера trg_order_status_notify_change");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateOrderStatusNotifyTrigger"), "Створення тригера trg_order_status_notify_change");
+    if(success) success &= executeQuery(query, getSqlQuery("DropCartItemNotifyTrigger"), "Видалення тригера trg_cart_item_notify_change");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateCartItemNotifyTrigger"), "Створення тригера trg_cart_item_notify_change");
+    return success;
+}
+
+bool DatabaseManager::triggerHasArgument(const QString &tableName, const QString &triggerName, const QString &argument) const
+{
+    QSqlQuery query(m_db);
+    query.prepare(getSqlQuery("CheckTriggerHasArgument"));
+    query.bindValue(":tableName", tableName);
+    query.bindValue(":triggerName", triggerName);
+    query.bindValue(":argument", argument);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Не вдалося перевірити аргументи тригера" << triggerName << ":" << query.lastError().text();
+        return false;
+    }
+    return query.value("has_argument").toBool();
+}
+
+bool DatabaseManager::columnExists(const QString &tableName, const QString &columnName) const
+{
+    QSqlQuery query(m_db);
+    query.prepare(getSqlQuery("CheckColumnExists"));
+    query.bindValue(":tableName", tableName);
+    query.bindValue(":columnName", columnName);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Не вдалося перевірити наявність колонки" << tableName << "." << columnName << ":" << query.lastError().text();
+        return false;
+    }
+    return query.value("column_exists").toBool();
+}
+
+bool DatabaseManager::indexExists(const QString &indexName) const
+{
+    QSqlQuery query(m_db);
+    query.prepare(getSqlQuery("CheckIndexExists"));
+    query.bindValue(":indexName", indexName);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Не вдалося перевірити наявність індексу" << indexName << ":" << query.lastError().text();
+        return false;
+    }
+    return query.value("index_exists").toBool();
+}
+
+bool DatabaseManager::functionSourceContains(const QString &functionName, const QString &fragment) const
+{
+    QSqlQuery query(m_db);
+    query.prepare(getSqlQuery("CheckFunctionSourceContains"));
+    query.bindValue(":functionName", functionName);
+    query.bindValue(":fragment", fragment);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Не вдалося перевірити функцію" << functionName << ":" << query.lastError().text();
+        return false;
+    }
+    return query.value("source_contains").toBool();
+}
+
+// Доводить схему вже існуючої БД до поточної версії (без перестворення таблиць).
+// Кожен крок виконується лише тоді, коли відповідної колонки ще немає.
+// pg_trgm та його індекси створюються окремо від транзакції: без прав на CREATE EXTENSION
+// оновлення не має відкочуватись, а createSearchExtensions() ідемпотентна (IF NOT EXISTS).
+bool DatabaseManager::upgradeSchema()
+{
+    if (!m_isConnected || !m_db.isOpen()) {
+        qWarning() << "upgradeSchema: немає активного з'єднання з БД.";
+        return false;
+    }
+    const bool needsAuthorsText = !columnExists("book", "authors_text");
+    const bool needsRatings = !columnExists("book", "rating_sum");
+    const bool needsSimilarity = !columnExists("book_similarity", "similar_book_id");
+    // Старіші тригери book надсилали лише залишок і ціну — перестворюються з повним рядком
+    // Старіші схеми не мали тригера author (кеш списку авторів не скидався), не передавали image_path
+    // або backend_pid (за ним впізнаються власні записи фонових з'єднань)
+    const bool needsNotifications = !triggerHasArgument("book", "trg_book_notify_change", "rating_avg")
+                                    || !triggerHasArgument("author", "trg_author_notify_change", "image_path")
+                                    || !functionSourceContains("notify_bookstore_change", "backend_pid");
+    // Індекс, що дублює префікс idx_book_genre_book_id, лише сповільнює запис у book
+    const bool hasLegacyGenreIndex = indexExists("idx_book_genre");
+    if (!needsAuthorsText && !needsRatings && !needsSimilarity && !needsNotifications && !hasLegacyGenreIndex) {
+        createSearchExtensions(); // Не критично: без pg_trgm працює пошук за префіксом
+        return true;
+    }
+
+    qInfo() << "Оновлення схеми БД...";
+    if (!m_db.transaction()) {
+        qCritical() << "Не вдалося почати транзакцію оновлення схеми:" << m_db.lastError().text();
+        return false;
+    }
+    clearPreparedQueries();
+
+    QSqlQuery query(m_db);
+    bool success = true;
+    if (needsAuthorsText) {
+        success &= executeQuery(query, getSqlQuery("AddBookAuthorsTextColumn"), "Додавання колонки book.authors_text");
+        if(success) success &= createBookAuthorsTextObjects(query);
+        if(success) success &= executeQuery(query, getSqlQuery("RefreshAllBookAuthorsText"), "Заповнення book.authors_text");
+    }
+    if (needsRatings && success) {
+        success &= executeQuery(query, getSqlQuery("AddBookRatingColumns"), "Додавання колонок book.rating_sum/rating_count/rating_avg");
+        if(success) success &= createBookRatingObjects(query);
+        if(success) success &= executeQuery(query, getSqlQuery("RefreshAllBookRatings"), "Заповнення агрегатів оцінок");
+        if(success) success &= executeQuery(query, getSqlQuery("CreateCalculateAverageRatingFunction"), "Оновлення функції calculate_average_book_rating");
+    }
+    if (needsSimilarity && success) {
+        // Таблиця заповнюється пізніше фоновим rebuildBookSimilarity(), індекс створить verifyIndexes()
+        success &= executeQuery(query, getSqlQuery("CreateBookSimilarityTable"), "Створення book_similarity");
+    }
+    if (needsNotifications && success) {
+        success &= createChangeNotificationObjects(query);
+    }
+    if (hasLegacyGenreIndex && success) {
+        success &= executeQuery(query, getSqlQuery("DropLegacyBookGenreIndex"), "Видалення застарілого індексу idx_book_genre");
+    }
+
+    if (success && m_db.commit()) {
+        qInfo() << "Схему оновлено.";
+        createSearchExtensions();
+        return true;
+    }
+    qCritical() << "Помилка оновлення схеми, відкат транзакції:" << m_db.lastError().text();
+    m_db.rollback();
+    return false;
+}
+
+// Створює всі індекси з sql/indexes.sql (у межах поточної транзакції)
+bool DatabaseManager::createManagedIndexes(QSqlQuery &query)
+{
+    if (m_managedIndexQueries.isEmpty()) {
+        qWarning() << "Керований набір індексів порожній: sql/indexes.sql не завантажено?";
+        return true;
+    }
+    bool success = true;
+    for (const QString &queryName : std::as_const(m_managedIndexQueries)) {
+        const QString sql = getSqlQuery(queryName);
+        success &= executeQuery(query, sql, QString("Створення індексу %1").arg(indexNameFromSql(sql)));
+        if (!success) {
+            break;
+        }
+    }
+    return success;
+}
+
+QString DatabaseManager::indexNameFromSql(const QString &sql)
+{
+    static const QRegularExpression indexNamePattern("CREATE\\s+(?:UNIQUE\\s+)?INDEX\\s+(?:CONCURRENTLY\\s+)?(?:IF\\s+NOT\\s+EXISTS\\s+)?\"?(\\w+)\"?",
+                                                     QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpressionMatch match = indexNamePattern.match(sql);
+    return match.hasMatch() ? match.captured(1) : QString();
+}
+
+bool DatabaseManager::verifyIndexes(bool createMissing)
+{
+    if (!m_isConnected || !m_db.isOpen()) {
+        qWarning() << "verifyIndexes: немає активного з'єднання з БД.";
+        return false;
+    }
+
+    // Ім'я індексу -> запит, що його створює
+    QMap<QString, QString> expected;
+    for (const QString &queryName : std::as_const(m_managedIndexQueries)) {
+        const QString indexName = indexNameFromSql(getSqlQuery(queryName));
+        if (indexName.isEmpty()) {
+            qWarning() << "verifyIndexes: не вдалося визначити ім'я індексу в запиті" << queryName;
+            continue;
+        }
+        expected.insert(indexName.toLower(), queryName);
+    }
+    if (expected.isEmpty()) {
+        return true;
+    }
+
+    QSqlQuery query(m_db);
+    if (!query.prepare(getSqlQuery("GetExistingIndexNames"))) {
+        qCritical() << "verifyIndexes: помилка підготовки запиту:" << query.lastError().text();
+        return false;
+    }
+    query.bindValue(":indexNames", "{" + expected.keys().join(',') + "}");
+    if (!query.exec()) {
+        qCritical() << "verifyIndexes: помилка перевірки індексів:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        expected.remove(query.value(0).toString().toLower());
+    }
+
+    if (expected.isEmpty()) {
+        qInfo() << "Усі" << m_managedIndexQueries.size() << "керованих індексів на місці.";
+        return true;
+    }
+    qWarning() << "Відсутні індекси:" << expected.keys();
+    if (!createMissing) {
+        return false;
+    }
+
+    bool success = true;
+    for (auto it = expected.cbegin(); it != expected.cend(); ++it) {
+        success &= executeQuery(query, getSqlQuery(it.value()), QString("Створення відсутнього індексу %1").arg(it.key()));
+    }
+    return success;
+}
+
+// Розширення pg_trgm та GIN-індекси для нечіткого пошуку підказок.
+// Виконується поза транзакцією схеми, бо CREATE EXTENSION потребує окремих прав.
+bool DatabaseManager::createSearchExtensions()
+{
+    QSqlQuery query(m_db);
+    bool success = executeQuery(query, getSqlQuery("CreatePgTrgmExtension"), "Створення розширення pg_trgm");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateBookTitleTrgmIndex"), "Створення триграмного індексу book(title)");
+    if(success) success &= executeQuery(query, getSqlQuery("CreateAuthorNameTrgmIndex"), "Створення триграмного індексу author(name)");
+    if (!success) {
+        qWarning() << "Нечіткий пошук недоступний: не вдалося створити pg_trgm або його індекси.";
+    }
+    return success;
+}
+
 // Допоміжні функції виконання запитів
 bool DatabaseManager::executeQuery(QSqlQuery &query, const QString &sql, const QString &description)
 {
@@ -208,8 +481,31 @@ QSqlError DatabaseManager::lastError() const
     }
 }
 
+void DatabaseManager::adoptConnection(const QSqlDatabase &db)
+{
+    if (!m_ownsConnection && m_db.isOpen() && m_db.connectionName() == db.connectionName()) {
+        return; // Те саме з'єднання з пулу — зберігаємо кеш підготовлених запитів
+    }
+    closeConnection();
+    m_db = db;
+    m_ownsConnection = false;
+    m_isConnected = m_db.isOpen();
+}
+
 void DatabaseManager::closeConnection()
 {
+    stopAsyncWorkers();
+    // Підготовлені запити належать цьому з'єднанню і мають бути знищені до removeDatabase
+    clearPreparedQueries();
+
+    if (!m_ownsConnection) {
+        // З'єднанням керує пул — лише відпускаємо нашу копію
+        m_db = QSqlDatabase();
+        m_isConnected = false;
+        m_ownsConnection = true;
+        return;
+    }
+
     if (m_db.isOpen()) { // Перевіряємо, чи з'єднання відкрите перед закриттям
         QString connectionName = m_db.connectionName();
         m_db.close();
@@ -315,6 +611,7 @@ bool DatabaseManager::printAllData() const
 bool DatabaseManager::loadSqlQueries(const QString& directory)
 {
     m_sqlQueries.clear(); // Очищуємо попередні запити
+    m_managedIndexQueries.clear();
     QDir sqlDir(directory);
     if (!sqlDir.exists()) {
         qCritical() << "SQL directory not found:" << sqlDir.absolutePath();
@@ -322,12 +619,20 @@ bool DatabaseManager::loadSqlQueries(const QString& directory)
     }
 
     qInfo() << "Loading SQL queries from directory:" << sqlDir.absolutePath();
-    QStringList sqlFiles = sqlDir.entryList(QStringList() << "*.sql", QDir::Files);
+    // Рекурсивно, щоб підхопити також sql/functions/*.sql
+    QStringList sqlFiles;
+    QDirIterator it(sqlDir.absolutePath(), QStringList() << "*.sql", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        sqlFiles << it.next();
+    }
+    sqlFiles.sort(); // Стабільний порядок завантаження
     bool allParsed = true;
 
-    for (const QString& fileName : sqlFiles) {
-        QString filePath = sqlDir.absoluteFilePath(fileName);
-        if (!parseSqlFile(filePath)) {
+    for (const QString& filePath : std::as_const(sqlFiles)) {
+        const QString fileName = QFileInfo(filePath).fileName();
+        // Запити з indexes.sql утворюють керований набір індексів
+        QStringList *parsedNames = fileName == "indexes.sql" ? &m_managedIndexQueries : nullptr;
+        if (!parseSqlFile(filePath, parsedNames)) {
             qWarning() << "Failed to parse SQL file:" << filePath;
             allParsed = false; // Продовжуємо завантажувати інші файли
         }
@@ -341,7 +646,7 @@ bool DatabaseManager::loadSqlQueries(const QString& directory)
 }
 
 // Парсить один .sql файл і додає запити до m_sqlQueries
-bool DatabaseManager::parseSqlFile(const QString& filePath)
+bool DatabaseManager::parseSqlFile(const QString& filePath, QStringList *parsedQueryNames)
 {
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -361,6 +666,7 @@ bool DatabaseManager::parseSqlFile(const QString& filePath)
             // Зберігаємо попередній запит, якщо він був
             if (!currentQueryName.isEmpty() && !currentQuerySql.isEmpty()) {
                 m_sqlQueries.insert(currentQueryName, currentQuerySql.trimmed());
+                if (parsedQueryNames) parsedQueryNames->append(currentQueryName);
                 queryCount++;
                 // qInfo() << "Parsed query:" << currentQueryName << "from file:" << filePath;
             }
@@ -382,6 +688,7 @@ bool DatabaseManager::parseSqlFile(const QString& filePath)
     // Зберігаємо останній запит у файлі
     if (!currentQueryName.isEmpty() && !currentQuerySql.isEmpty()) {
         m_sqlQueries.insert(currentQueryName, currentQuerySql.trimmed());
+        if (parsedQueryNames) parsedQueryNames->append(currentQueryName);
         queryCount++;
         // qInfo() << "Parsed query:" << currentQueryName << "from file:" << filePath;
     }
@@ -401,3 +708,60 @@ QString DatabaseManager::getSqlQuery(const QString& queryName) const
     }
     return m_sqlQueries.value(queryName);
 }
+
+// Повертає підготовлений запит з кешу поточного з'єднання.
+// QPSQL виконує prepare() на сервері (PREPARE), тому повторні виклики
+// пропускають розбір і планування запиту.
+QSqlQuery *DatabaseManager::preparedQuery(const QString& queryName) const
+{
+    auto it = m_preparedQueries.find(queryName);
+    if (it != m_preparedQueries.end()) {
+        QSqlQuery *query = it.value().data();
+        // Після помилки виконання (напр., розірване з'єднання) запит готуємо заново
+        if (!query->lastError().isValid()) {
+            query->finish(); // Звільняємо результат попереднього виконання
+            ++m_preparedQueryHits;
+            return query;
+        }
+        m_preparedQueries.erase(it);
+    }
+
+    ++m_preparedQueryMisses;
+    const QString sql = getSqlQuery(queryName);
+    if (sql.isEmpty()) return nullptr;
+
+    QSharedPointer<QSqlQuery> query(new QSqlQuery(m_db));
+    if (!query->prepare(sql)) {
+        qCritical() << "Помилка підготовки запиту" << queryName << ":" << query->lastError().text();
+        return nullptr;
+    }
+    m_preparedQueries.insert(queryName, query);
+    return query.data();
+}
+
+void DatabaseManager::clearPreparedQueries() const
+{
+    if (!m_preparedQueries.isEmpty()) {
+        qInfo() << "Кеш підготовлених запитів очищено. Влучань:" << m_preparedQueryHits << ", промахів:" << m_preparedQueryMisses;
+    }
+    m_preparedQueries.clear();
+}
+
+DatabaseManager::PreparedStatementStats DatabaseManager::preparedStatementStats() const
+{
+    PreparedStatementStats stats;
+    stats.hits = m_preparedQueryHits;
+    stats.misses = m_preparedQueryMisses;
+    stats.cachedStatements = m_preparedQueries.size();
+    return stats;
+}
+
+QString DatabaseManager::toPostgresIntArray(const QList<int> &ids)
+{
+    QStringList parts;
+    parts.reserve(ids.size());
+    for (int id : ids) {
+        parts.append(QString::number(id));
+    }
+    return "{" + parts.join(',') + "}";
+}
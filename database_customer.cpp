@@ -16,14 +16,9 @@ CustomerLoginInfo DatabaseManager::getCustomerLoginInfo(const QString &email) co
         return loginInfo;
     }
 
-    const QString sql = getSqlQuery("GetCustomerLoginInfoByEmail");
-    if (sql.isEmpty()) return loginInfo;
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'GetCustomerLoginInfoByEmail':" << query.lastError().text();
-        return loginInfo;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("GetCustomerLoginInfoByEmail");
+    if (!cachedQuery) return loginInfo;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":email", email);
 
     qInfo() << "Executing SQL 'GetCustomerLoginInfoByEmail' for email:" << email;
@@ -56,14 +51,9 @@ CustomerProfileInfo DatabaseManager::getCustomerProfileInfo(int customerId) cons
         return profileInfo;
     }
 
-    const QString sql = getSqlQuery("GetCustomerProfileInfoById");
-    if (sql.isEmpty()) return profileInfo;
-
-    QSqlQuery query(m_db);
-    if (!query.prepare(sql)) {
-        qCritical() << "Помилка підготовки запиту 'GetCustomerProfileInfoById':" << query.lastError().text();
-        return profileInfo;
-    }
+    QSqlQuery *cachedQuery = preparedQuery("GetCustomerProfileInfoById");
+    if (!cachedQuery) return profileInfo;
+    QSqlQuery &query = *cachedQuery;
     query.bindValue(":customerId", customerId);
 
     qInfo() << "Executing SQL 'GetCustomerProfileInfoById' for customer ID:" << customerId;
@@ -0,0 +1,105 @@
+#include "database.h"
+#include "databaseconnectionpool.h"
+#include "queryresultcache.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlDriver>
+
+// --- Сповіщення про зміни в БД (LISTEN/NOTIFY) ---
+// Тригери з sql/functions/change_notifications.sql надсилають JSON у канал bookstore_changes.
+// QPSQL доставляє їх через QSqlDriver::notification у потоці, якому належить з'єднання,
+// тому підписуватися має менеджер основного (GUI) з'єднання, а не фонові воркери.
+
+namespace {
+const char kChangeChannel[] = "bookstore_changes";
+
+DatabaseManager::ChangeOperation operationFromString(const QString &op)
+{
+    if (op == QLatin1String("INSERT")) return DatabaseManager::ChangeOperation::Insert;
+    if (op == QLatin1String("DELETE")) return DatabaseManager::ChangeOperation::Delete;
+    return DatabaseManager::ChangeOperation::Update;
+}
+}
+
+bool DatabaseManager::startChangeNotifications()
+{
+    if (!m_isConnected || !m_db.isOpen()) {
+        qWarning() << "startChangeNotifications: немає активного з'єднання з БД.";
+        return false;
+    }
+    QSqlDriver *driver = m_db.driver();
+    if (!driver || !driver->hasFeature(QSqlDriver::EventNotifications)) {
+        qWarning() << "Драйвер БД не підтримує сповіщення LISTEN/NOTIFY.";
+        return false;
+    }
+    if (driver->subscribedToNotifications().contains(kChangeChannel)) {
+        return true;
+    }
+    if (!driver->subscribeToNotification(kChangeChannel)) {
+        qWarning() << "Не вдалося підписатися на канал" << kChangeChannel << ":" << driver->lastError().text();
+        return false;
+    }
+
+    connect(driver, QOverload<const QString &, QSqlDriver::NotificationSource, const QVariant &>::of(&QSqlDriver::notification),
+            this, [this](const QString &name, QSqlDriver::NotificationSource source, const QVariant &payload) {
+        if (name == QLatin1String(kChangeChannel)) {
+            handleChangeNotification(payload.toString(), source == QSqlDriver::SelfSource);
+        }
+    });
+    qInfo() << "Підписано на сповіщення про зміни:" << kChangeChannel;
+    return true;
+}
+
+void DatabaseManager::handleChangeNotification(const QString &payload, bool fromThisConnection)
+{
+    const QJsonObject change = QJsonDocument::fromJson(payload.toUtf8()).object();
+    const QString table = change.value("table").toString();
+    const ChangeOperation operation = operationFromString(change.value("op").toString());
+    // QPSQL порівнює відправника лише з цим з'єднанням; записи фонових потоків (оформлення
+    // замовлення, корекція кошика) впізнаються за backend_pid з'єднань пулу
+    if (!fromThisConnection && m_connectionPool) {
+        fromThisConnection = m_connectionPool->ownsBackendPid(change.value("backend_pid").toInt());
+    }
+
+    // Рейтинг у списках книг рахується з comment, тож обидві таблиці скидають тег "book"
+    if (table == QLatin1String("book") || table == QLatin1String("comment")) {
+        QueryResultCache::instance().invalidateTag(QStringLiteral("book"));
+    } else if (table == QLatin1String("author")) {
+        QueryResultCache::instance().invalidateTag(QStringLiteral("author"));
+    }
+
+    if (table == QLatin1String("book")) {
+        BookChangeInfo bookChange;
+        bookChange.book.bookId = change.value("book_id").toInt();
+        bookChange.book.title = change.value("title").toString();
+        bookChange.book.authors = change.value("authors_text").toString();
+        bookChange.book.price = change.value("price").toDouble();
+        bookChange.book.coverImagePath = change.value("cover_image_path").toString();
+        bookChange.book.stockQuantity = change.value("stock_quantity").toInt();
+        bookChange.book.genre = change.value("genre").toString();
+        bookChange.book.ratingSum = change.value("rating_sum").toInt();
+        bookChange.book.ratingCount = change.value("rating_count").toInt();
+        bookChange.book.found = true;
+        bookChange.language = change.value("language").toString();
+        bookChange.ratingAvgCents = qRound(change.value("rating_avg").toDouble() * 100.0);
+        emit bookChanged(bookChange, operation);
+    } else if (table == QLatin1String("author")) {
+        // authors_text книг оновлюють тригери, і він приходить сповіщенням book
+        AuthorDisplayInfo author;
+        author.authorId = change.value("author_id").toInt();
+        author.firstName = change.value("first_name").toString();
+        author.lastName = change.value("last_name").toString();
+        author.imagePath = change.value("image_path").toString();
+        emit authorChanged(author, operation);
+    } else if (table == QLatin1String("comment")) {
+        emit commentChanged(change.value("book_id").toInt(), change.value("comment_id").toInt(), operation);
+    } else if (table == QLatin1String("order_status")) {
+        emit orderStatusChanged(change.value("order_id").toInt(), change.value("status").toString(), operation);
+    } else if (table == QLatin1String("cart_item")) {
+        emit cartItemChanged(change.value("customer_id").toInt(), change.value("book_id").toInt(),
+                             change.value("quantity").toInt(), operation, fromThisConnection);
+    } else {
+        qWarning() << "Невідоме сповіщення про зміну:" << payload;
+    }
+}
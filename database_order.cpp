@@ -1,4 +1,5 @@
 #include "database.h"
+#include "queryresultcache.h"
 #include <QDebug>
 #include <QSqlDatabase>
 #include <QSqlError>
@@ -6,6 +7,24 @@
 #include <QVariant>
 #include <QMap>
 #include <QDateTime>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QThread>
+#include <QCoreApplication>
+
+namespace {
+// Повтори транзакції оформлення замовлення при конфліктах з іншими касами
+const int kMaxOrderAttempts = 4;
+const int kOrderRetryBaseDelayMs = 25;
+const int kOrderRetryMaxDelayMs = 400;
+
+// 40001 — serialization_failure, 40P01 — deadlock_detected (SQLSTATE PostgreSQL)
+bool isRetryableTransactionError(const QSqlError &error)
+{
+    const QString sqlState = error.nativeErrorCode();
+    return sqlState == QLatin1String("40001") || sqlState == QLatin1String("40P01");
+}
+}
 
 OrderDisplayInfo DatabaseManager::getOrderDetailsById(int orderId) const
 {
@@ -114,10 +133,16 @@ OrderDisplayInfo DatabaseManager::getOrderDetailsById(int orderId) const
     return orderInfo;
 }
 
-double DatabaseManager::createOrder(int customerId, const QMap<int, int> &items, const QString &shippingAddress, const QString &paymentMethod, int &newOrderId)
+// Замовлення оформлюється одним запитом PlaceOrder (sql/order_queries.sql): кошик передається
+// масивами book_id/quantity, а залишки, позиції, сума, статус, бонусні бали та кошик
+// змінюються на сервері за один прохід і фіксуються одним комітом.
+// Блокуючий виклик (очікування FOR UPDATE, паузи між повторами): з GUI використовуйте createOrderAsync.
+double DatabaseManager::createOrder(int customerId, const QMap<int, int> &items, const QString &shippingAddress, const QString &paymentMethod, int &newOrderId,
+                                   int *loyaltyPointsAwarded)
 {
     newOrderId = -1;
-    double calculatedTotalAmount = 0.0;
+    if (loyaltyPointsAwarded) *loyaltyPointsAwarded = 0;
+    m_lastOrderAttempts = 0;
     const double errorReturnValue = -1.0;
 
     if (!m_isConnected || !m_db.isOpen()) {
@@ -129,168 +154,131 @@ double DatabaseManager::createOrder(int customerId, const QMap<int, int> &items,
         return errorReturnValue;
     }
 
-    if (!m_db.transaction()) {
-        qCritical() << "Не вдалося почати транзакцію для створення замовлення:" << m_db.lastError().text();
+    QList<int> bookIds;
+    QList<int> quantities;
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        if (it.value() <= 0) {
+            qWarning() << "Пропущено позицію з невірною кількістю (" << it.value() << ") для книги ID" << it.key();
+            continue;
+        }
+        bookIds.append(it.key());
+        quantities.append(it.value());
+    }
+    if (bookIds.isEmpty()) {
+        qWarning() << "Неможливо створити замовлення: у кошику немає позицій з додатною кількістю.";
         return errorReturnValue;
     }
-    qInfo() << "Транзакція для створення замовлення розпочата...";
-
-    QSqlQuery query(m_db);
-    bool success = true;
-    QVariant lastId;
 
-    const QString insertOrderSQL = getSqlQuery("InsertOrderHeader");
-    if (insertOrderSQL.isEmpty()) {
-        success = false;
-    } else if (!query.prepare(insertOrderSQL)) {
-        qCritical() << "Помилка підготовки запиту 'InsertOrderHeader':" << query.lastError().text();
-        success = false;
-    } else {
-        qInfo() << "Executing SQL 'InsertOrderHeader' for customer ID:" << customerId;
-        query.bindValue(":customer_id", customerId);
-        query.bindValue(":shipping_address", shippingAddress);
-        query.bindValue(":payment_method", paymentMethod.isEmpty() ? QVariant(QVariant::String) : paymentMethod);
-
-        if (executeInsertQuery(query, "Insert Order Header", lastId)) {
-            newOrderId = lastId.toInt();
-            qInfo() << "Створено заголовок замовлення з ID:" << newOrderId;
+    // Конфлікти з іншими касами (serialization failure / deadlock) не є помилкою замовлення:
+    // транзакція повторюється цілком після паузи, що зростає експоненційно, з випадковим розкидом
+    for (int attempt = 1; attempt <= kMaxOrderAttempts; ++attempt) {
+        m_lastOrderAttempts = attempt;
+        bool retryable = false;
+        int points = 0;
+        const double totalAmount = placeOrderAttempt(customerId, bookIds, quantities, shippingAddress, paymentMethod, newOrderId, points, retryable);
+        if (totalAmount >= 0.0) {
+            if (loyaltyPointsAwarded) *loyaltyPointsAwarded = points;
+            // Залишки змінилися; NOTIFY дійде пізніше, тож скидаємо кеш одразу
+            QueryResultCache::instance().invalidateTag(QStringLiteral("book"));
+            return totalAmount;
+        }
+        if (!retryable || attempt == kMaxOrderAttempts) {
+            break;
+        }
+        const int delayMs = qMin(kOrderRetryMaxDelayMs, kOrderRetryBaseDelayMs << (attempt - 1));
+        const int jitteredDelayMs = delayMs / 2 + QRandomGenerator::global()->bounded(delayMs / 2 + 1);
+        qWarning() << "Конфлікт транзакцій при створенні замовлення (спроба" << attempt << "з" << kMaxOrderAttempts
+                   << "), повтор через" << jitteredDelayMs << "мс";
+        if (QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread()) {
+            qWarning() << "createOrder викликано з GUI-потоку: повтор без паузи (використовуйте createOrderAsync)";
         } else {
-            success = false;
+            QThread::msleep(static_cast<unsigned long>(jitteredDelayMs));
         }
     }
+    newOrderId = -1;
+    return errorReturnValue;
+}
 
-    if (success) {
-        const QString insertItemSQL = getSqlQuery("InsertOrderItem");
-        const QString getBookPriceSQL = getSqlQuery("GetBookPriceAndStockForUpdate");
-        const QString updateStockSQL = getSqlQuery("UpdateBookStock");
+int DatabaseManager::lastOrderAttempts() const
+{
+    return m_lastOrderAttempts;
+}
 
-        if (insertItemSQL.isEmpty() || getBookPriceSQL.isEmpty() || updateStockSQL.isEmpty()) {
-             qCritical() << "Помилка завантаження SQL запитів для створення позицій замовлення.";
-             success = false;
-        } else {
-            QSqlQuery itemQuery(m_db);
-            QSqlQuery priceQuery(m_db);
-            QSqlQuery updateStockQuery(m_db);
-
-            if (!itemQuery.prepare(insertItemSQL) || !priceQuery.prepare(getBookPriceSQL) || !updateStockQuery.prepare(updateStockSQL)) {
-                qCritical() << "Помилка підготовки запитів для позицій замовлення, ціни або оновлення кількості:"
-                            << itemQuery.lastError().text() << priceQuery.lastError().text() << updateStockQuery.lastError().text();
-                success = false;
-            } else {
-                for (auto it = items.constBegin(); it != items.constEnd() && success; ++it) {
-                int bookId = it.key();
-                int quantity = it.value();
-
-                if (quantity <= 0) {
-                    qWarning() << "Пропущено позицію з невірною кількістю (" << quantity << ") для книги ID" << bookId;
-                    continue;
-                }
-
-                qInfo() << "Executing SQL 'GetBookPriceAndStockForUpdate' for book ID:" << bookId;
-                priceQuery.bindValue(":book_id", bookId);
-                if (!priceQuery.exec()) {
-                    qCritical() << "Помилка виконання 'GetBookPriceAndStockForUpdate' для книги ID" << bookId << ":" << priceQuery.lastError().text();
-                    success = false;
-                    break;
-                }
-
-                if (priceQuery.next()) {
-                    double currentPrice = priceQuery.value(0).toDouble();
-                    int currentStock = priceQuery.value(1).toInt();
-
-                    if (quantity > currentStock) {
-                         qWarning() << "Недостатньо товару на складі для книги ID" << bookId << "(замовлено:" << quantity << ", на складі:" << currentStock << "). Замовлення скасовано.";
-                         success = false;
-                         break;
-                    }
-
-                    qInfo() << "Executing SQL 'UpdateBookStock' for book ID:" << bookId << "Quantity:" << quantity;
-                    updateStockQuery.bindValue(":quantity", quantity);
-                    updateStockQuery.bindValue(":book_id", bookId);
-                    if (!updateStockQuery.exec()) {
-                        qCritical() << "Помилка виконання 'UpdateBookStock' для книги ID" << bookId << ":" << updateStockQuery.lastError().text();
-                        success = false;
-                        break;
-                    }
-                    if (updateStockQuery.numRowsAffected() == 0) {
-                        qWarning() << "Не вдалося виконати 'UpdateBookStock' для книги ID" << bookId << "(можливо, кількість змінилася або недостатньо). Замовлення скасовано.";
-                        success = false;
-                        break;
-                    }
-
-
-                    itemQuery.bindValue(":order_id", newOrderId);
-                    itemQuery.bindValue(":book_id", bookId);
-                    itemQuery.bindValue(":quantity", quantity);
-                    itemQuery.bindValue(":price_per_unit", currentPrice);
-
-                    qInfo() << "Executing SQL 'InsertOrderItem' for order ID:" << newOrderId << "Book ID:" << bookId;
-                    if (!itemQuery.exec()) {
-                        qCritical() << "Помилка виконання 'InsertOrderItem' для книги ID" << bookId << ":" << itemQuery.lastError().text();
-                        success = false;
-                        break;
-                    }
-                    calculatedTotalAmount += currentPrice * quantity;
-                    qInfo() << "Додано позицію: Книга ID" << bookId << ", Кількість:" << quantity << ", Ціна:" << currentPrice << ". Оновлено кількість на складі.";
-
-                } else {
-                    qWarning() << "Книгу з ID" << bookId << "не знайдено при створенні замовлення. Замовлення скасовано.";
-                    success = false;
-                    break;
-                }
-            }
-        }
+// Одна спроба оформлення замовлення в окремій транзакції.
+// retryable = true, якщо транзакцію скасовано через конфлікт (40001/40P01) і її варто повторити.
+double DatabaseManager::placeOrderAttempt(int customerId, const QList<int> &bookIds, const QList<int> &quantities,
+                                          const QString &shippingAddress, const QString &paymentMethod,
+                                          int &newOrderId, int &loyaltyPointsAwarded, bool &retryable)
+{
+    newOrderId = -1;
+    loyaltyPointsAwarded = 0;
+    retryable = false;
+    const double errorReturnValue = -1.0;
+
+    if (!m_db.transaction()) {
+        qCritical() << "Не вдалося почати транзакцію для створення замовлення:" << m_db.lastError().text();
+        return errorReturnValue;
     }
+    qInfo() << "Транзакція для створення замовлення розпочата...";
 
-    if (success) {
-        const QString updateTotalSQL = getSqlQuery("UpdateOrderTotalAmount");
-        if (updateTotalSQL.isEmpty()) {
-            success = false;
-        } else if (!query.prepare(updateTotalSQL)) {
-            qCritical() << "Помилка підготовки запиту 'UpdateOrderTotalAmount':" << query.lastError().text();
-            success = false;
+    double totalAmount = errorReturnValue;
+    bool success = false;
+
+    // Рядки книг блокуються заздалегідь у порядку book_id: дві каси з перетином кошиків
+    // чекають одна на одну, а не утворюють цикл блокувань у порядку, який обрав планувальник UPDATE
+    bool locked = false;
+    QSqlQuery *lockQuery = preparedQuery("LockBooksForOrder");
+    if (lockQuery) {
+        lockQuery->bindValue(":bookIds", toPostgresIntArray(bookIds));
+        if (lockQuery->exec()) {
+            locked = true;
         } else {
-            qInfo() << "Executing SQL 'UpdateOrderTotalAmount' for order ID:" << newOrderId;
-            query.bindValue(":total", calculatedTotalAmount);
-            query.bindValue(":order_id", newOrderId);
-            if (!query.exec()) {
-                qCritical() << "Помилка виконання 'UpdateOrderTotalAmount' для замовлення ID" << newOrderId << ":" << query.lastError().text();
-                success = false;
-            } else {
-                qInfo() << "Оновлено загальну суму замовлення ID" << newOrderId << " до" << calculatedTotalAmount;
-            }
+            qCritical() << "Помилка виконання 'LockBooksForOrder':" << lockQuery->lastError().text();
+            retryable = isRetryableTransactionError(lockQuery->lastError());
         }
+        lockQuery->finish();
     }
 
-    if (success) {
-        const QString insertStatusSQL = getSqlQuery("InsertOrderStatus");
-         if (insertStatusSQL.isEmpty()) {
-            success = false;
-        } else if (!query.prepare(insertStatusSQL)) {
-            qCritical() << "Помилка підготовки запиту 'InsertOrderStatus':" << query.lastError().text();
-            success = false;
+    QSqlQuery *cachedQuery = locked ? preparedQuery("PlaceOrder") : nullptr;
+    if (cachedQuery) {
+        QSqlQuery &query = *cachedQuery;
+        query.bindValue(":bookIds", toPostgresIntArray(bookIds));
+        query.bindValue(":quantities", toPostgresIntArray(quantities));
+        query.bindValue(":customerId", customerId);
+        query.bindValue(":shippingAddress", shippingAddress);
+        query.bindValue(":paymentMethod", paymentMethod.isEmpty() ? QVariant(QVariant::String) : paymentMethod);
+        query.bindValue(":status", tr("Нове"));
+
+        qInfo() << "Executing SQL 'PlaceOrder' for customer ID:" << customerId << "items:" << bookIds.size();
+        if (!query.exec()) {
+            qCritical() << "Помилка виконання 'PlaceOrder':" << query.lastError().text();
+            retryable = isRetryableTransactionError(query.lastError());
+        } else if (!query.next()) {
+            qCritical() << "'PlaceOrder' не повернув результат.";
+        } else if (query.value("order_id").isNull()) {
+            qWarning() << "Недостатньо товару на складі або книгу не знайдено: списано"
+                       << query.value("updated_count").toInt() << "з" << query.value("requested_count").toInt()
+                       << "позицій. Замовлення скасовано.";
         } else {
-            qInfo() << "Executing SQL 'InsertOrderStatus' for order ID:" << newOrderId;
-            query.bindValue(":order_id", newOrderId);
-            query.bindValue(":status", tr("Нове"));
-            if (!query.exec()) {
-                qCritical() << "Помилка виконання 'InsertOrderStatus' для замовлення ID" << newOrderId << ":" << query.lastError().text();
-                success = false;
-            } else {
-                qInfo() << "Додано початковий статус 'Нове' для замовлення ID" << newOrderId;
-            }
+            newOrderId = query.value("order_id").toInt();
+            totalAmount = query.value("total_amount").toDouble();
+            loyaltyPointsAwarded = query.value("loyalty_points_awarded").toInt();
+            success = true;
         }
-    }
+        query.finish();
     }
 
-
     if (success) {
         if (m_db.commit()) {
-            qInfo() << "Транзакція створення замовлення ID" << newOrderId << "успішно завершена. Total:" << calculatedTotalAmount;
-            return calculatedTotalAmount;
+            qInfo() << "Транзакція створення замовлення ID" << newOrderId << "успішно завершена. Total:" << totalAmount
+                    << "Бонусних балів:" << loyaltyPointsAwarded;
+            return totalAmount;
         } else {
             qCritical() << "Помилка при коміті транзакції створення замовлення:" << m_db.lastError().text();
+            retryable = isRetryableTransactionError(m_db.lastError());
             m_db.rollback();
+            newOrderId = -1;
+            loyaltyPointsAwarded = 0;
             return errorReturnValue;
         }
     } else {
@@ -331,28 +319,9 @@ QList<OrderDisplayInfo> DatabaseManager::getCustomerOrdersForDisplay(int custome
         return orders;
     }
 
-    const QString itemsSql = getSqlQuery("GetOrderItemsByOrderId");
-    const QString statusesSql = getSqlQuery("GetOrderStatusesByOrderId");
-
-    if (itemsSql.isEmpty() || statusesSql.isEmpty()) {
-        qCritical() << "Помилка завантаження SQL запитів для позицій або статусів замовлень.";
-        return orders;
-    }
-
-    QSqlQuery itemQuery(m_db);
-    if (!itemQuery.prepare(itemsSql)) {
-         qCritical() << "Помилка підготовки запиту 'GetOrderItemsByOrderId' (для списку замовлень):" << itemQuery.lastError().text();
-         return orders;
-    }
-
-    QSqlQuery statusQuery(m_db);
-     if (!statusQuery.prepare(statusesSql)) {
-         qCritical() << "Помилка підготовки запиту 'GetOrderStatusesByOrderId' (для списку замовлень):" << statusQuery.lastError().text();
-         return orders;
-     }
-
-
     qInfo() << "Processing orders for customer ID:" << customerId;
+    QHash<int, int> orderIndexById; // order_id -> індекс у списку orders
+    QList<int> orderIds;
     int orderCount = 0;
     while (orderQuery.next()) {
         OrderDisplayInfo orderInfo;
@@ -377,38 +346,60 @@ QList<OrderDisplayInfo> DatabaseManager::getCustomerOrdersForDisplay(int custome
             qWarning() << "[DEBUG] Failed to parse date string:" << dateString << "using ISODate/ISODateWithMs formats.";
        }
 
-        itemQuery.bindValue(":orderId", orderInfo.orderId);
-        qInfo() << "Executing SQL 'GetOrderItemsByOrderId' for order ID:" << orderInfo.orderId << "(in list)";
-        if (!itemQuery.exec()) {
-            qCritical() << "Помилка при виконанні 'GetOrderItemsByOrderId' для order ID '" << orderInfo.orderId << "':";
-            qCritical() << itemQuery.lastError().text();
-            continue;
-        }
+        orderIndexById.insert(orderInfo.orderId, orders.size());
+        orderIds.append(orderInfo.orderId);
+        orders.append(orderInfo);
+        orderCount++;
+    }
+
+    if (orderIds.isEmpty()) {
+        qInfo() << "Processed 0 orders for customer ID:" << customerId;
+        return orders;
+    }
+
+    // Позиції та статуси всіх замовлень завантажуються двома запитами (замість 2 запитів на кожне замовлення)
+    const QString orderIdsArray = toPostgresIntArray(orderIds);
+
+    QSqlQuery *cachedItemsQuery = preparedQuery("GetOrderItemsByOrderIds");
+    if (!cachedItemsQuery) return orders;
+    QSqlQuery &itemQuery = *cachedItemsQuery;
+    itemQuery.bindValue(":orderIds", orderIdsArray);
+
+    qInfo() << "Executing SQL 'GetOrderItemsByOrderIds' for" << orderIds.size() << "orders";
+    if (!itemQuery.exec()) {
+        qCritical() << "Помилка при виконанні 'GetOrderItemsByOrderIds' для customer ID '" << customerId << "':";
+        qCritical() << itemQuery.lastError().text();
+    } else {
         while (itemQuery.next()) {
+            const int index = orderIndexById.value(itemQuery.value("order_id").toInt(), -1);
+            if (index < 0) continue;
             OrderItemDisplayInfo itemInfo;
             itemInfo.quantity = itemQuery.value("quantity").toInt();
             itemInfo.pricePerUnit = itemQuery.value("price_per_unit").toDouble();
             itemInfo.bookTitle = itemQuery.value("title").toString();
-            orderInfo.items.append(itemInfo);
+            orders[index].items.append(itemInfo);
         }
+    }
 
-        statusQuery.bindValue(":orderId", orderInfo.orderId);
-        qInfo() << "Executing SQL 'GetOrderStatusesByOrderId' for order ID:" << orderInfo.orderId << "(in list)";
-         if (!statusQuery.exec()) {
-            qCritical() << "Помилка при виконанні 'GetOrderStatusesByOrderId' для order ID '" << orderInfo.orderId << "':";
-            qCritical() << statusQuery.lastError().text();
-            continue;
-        }
+    QSqlQuery *cachedStatusQuery = preparedQuery("GetOrderStatusesByOrderIds");
+    if (!cachedStatusQuery) return orders;
+    QSqlQuery &statusQuery = *cachedStatusQuery;
+    statusQuery.bindValue(":orderIds", orderIdsArray);
+
+    qInfo() << "Executing SQL 'GetOrderStatusesByOrderIds' for" << orderIds.size() << "orders";
+    if (!statusQuery.exec()) {
+        qCritical() << "Помилка при виконанні 'GetOrderStatusesByOrderIds' для customer ID '" << customerId << "':";
+        qCritical() << statusQuery.lastError().text();
+    } else {
         while (statusQuery.next()) {
+            const int index = orderIndexById.value(statusQuery.value("order_id").toInt(), -1);
+            if (index < 0) continue;
             OrderStatusDisplayInfo statusInfo;
             statusInfo.status = statusQuery.value("status").toString();
             statusInfo.statusDate = statusQuery.value("status_date").toDateTime();
             statusInfo.trackingNumber = statusQuery.value("tracking_number").toString();
-            orderInfo.statuses.append(statusInfo);
+            orders[index].statuses.append(statusInfo);
         }
-
-        orders.append(orderInfo);
-        orderCount++;
     }
 
     qInfo() << "Processed" << orderCount << "orders for customer ID:" << customerId;
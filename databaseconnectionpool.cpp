@@ -0,0 +1,215 @@
+#include "databaseconnectionpool.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+
+DatabaseConnectionPool::DatabaseConnectionPool(const DatabaseConnectionConfig &config, int maxSize)
+    : m_config(config)
+    , m_maxSize(qMax(1, maxSize))
+{
+}
+
+DatabaseConnectionPool::~DatabaseConnectionPool()
+{
+    // Усі потоки мають закрити свої з'єднання до знищення пулу
+    QMutexLocker locker(&m_mutex);
+    if (!m_entries.isEmpty()) {
+        qWarning() << "DatabaseConnectionPool: знищення пулу з" << m_entries.size() << "незакритими з'єднаннями.";
+    }
+}
+
+QSqlDatabase DatabaseConnectionPool::acquire(int timeoutMs)
+{
+    QThread *thread = QThread::currentThread();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(thread);
+
+    if (it == m_entries.end()) {
+        // Нове з'єднання: чекаємо вільного місця в пулі
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        while (m_entries.size() >= m_maxSize) {
+            const qint64 remaining = timeoutMs - waitTimer.elapsed();
+            if (remaining <= 0) {
+                qWarning() << "DatabaseConnectionPool: не вдалося отримати з'єднання за" << timeoutMs << "мс (ліміт пулу" << m_maxSize << ").";
+                return QSqlDatabase();
+            }
+            m_slotFreed.wait(&m_mutex, static_cast<unsigned long>(remaining));
+        }
+
+        Entry entry;
+        entry.connectionName = QString("db_pool_%1").arg(m_nextConnectionId++);
+        m_entries.insert(thread, entry); // Резервуємо місце до відкриття з'єднання
+        const QString connectionName = entry.connectionName;
+
+        int backendPid = 0;
+        locker.unlock();
+        const bool opened = openConnection(connectionName, &backendPid);
+        locker.relock();
+
+        if (!opened) {
+            m_entries.remove(thread);
+            m_slotFreed.wakeOne();
+            return QSqlDatabase();
+        }
+        it = m_entries.find(thread);
+        it->backendPid = backendPid;
+    } else if (now - it->lastUsedMs > m_healthCheckIntervalMs) {
+        // З'єднання давно не використовувалось — сервер міг його розірвати
+        const QString connectionName = it->connectionName;
+        int backendPid = it->backendPid;
+        locker.unlock();
+        bool healthy = isHealthy(connectionName);
+        if (!healthy) {
+            qWarning() << "DatabaseConnectionPool: з'єднання" << connectionName << "не відповідає, перепідключення...";
+            removeConnection(connectionName);
+            healthy = openConnection(connectionName, &backendPid);
+        }
+        locker.relock();
+
+        if (!healthy) {
+            m_entries.remove(thread);
+            m_slotFreed.wakeOne();
+            return QSqlDatabase();
+        }
+        it = m_entries.find(thread);
+        it->backendPid = backendPid;
+    }
+
+    it->inUse = true;
+    it->lastUsedMs = now;
+    return QSqlDatabase::database(it->connectionName, false);
+}
+
+bool DatabaseConnectionPool::healthCheckDue() const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.constFind(QThread::currentThread());
+    return it != m_entries.constEnd()
+           && QDateTime::currentMSecsSinceEpoch() - it->lastUsedMs > m_healthCheckIntervalMs;
+}
+
+void DatabaseConnectionPool::release()
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(QThread::currentThread());
+    if (it != m_entries.end()) {
+        it->inUse = false;
+        it->lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    }
+}
+
+bool DatabaseConnectionPool::closeIfIdle(int idleTimeoutMs)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.constFind(QThread::currentThread());
+        if (it == m_entries.constEnd() || it->inUse) {
+            return false;
+        }
+        if (QDateTime::currentMSecsSinceEpoch() - it->lastUsedMs < idleTimeoutMs) {
+            return false;
+        }
+    }
+    qInfo() << "DatabaseConnectionPool: закриття з'єднання, що простоює, у потоці" << QThread::currentThread();
+    closeCurrentThreadConnection();
+    return true;
+}
+
+void DatabaseConnectionPool::closeCurrentThreadConnection()
+{
+    QString connectionName;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(QThread::currentThread());
+        if (it == m_entries.end()) {
+            return;
+        }
+        connectionName = it->connectionName;
+        m_entries.erase(it);
+    }
+    removeConnection(connectionName);
+    m_slotFreed.wakeOne();
+}
+
+void DatabaseConnectionPool::setHealthCheckInterval(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_healthCheckIntervalMs = ms;
+}
+
+int DatabaseConnectionPool::maxSize() const
+{
+    return m_maxSize;
+}
+
+int DatabaseConnectionPool::openConnections() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+bool DatabaseConnectionPool::ownsBackendPid(int backendPid) const
+{
+    if (backendPid <= 0) {
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    for (const Entry &entry : m_entries) {
+        if (entry.backendPid == backendPid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DatabaseConnectionPool::openConnection(const QString &connectionName, int *backendPid)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QPSQL", connectionName);
+    db.setHostName(m_config.host);
+    db.setPort(m_config.port);
+    db.setDatabaseName(m_config.dbName);
+    db.setUserName(m_config.user);
+    db.setPassword(m_config.password);
+
+    if (!db.open()) {
+        qCritical() << "DatabaseConnectionPool: не вдалося відкрити з'єднання" << connectionName << ":" << db.lastError().text();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName);
+        return false;
+    }
+    {
+        QSqlQuery query(db);
+        *backendPid = query.exec("SELECT pg_backend_pid()") && query.next() ? query.value(0).toInt() : 0;
+    }
+    qInfo() << "DatabaseConnectionPool: відкрито з'єднання" << connectionName << "у потоці" << QThread::currentThread()
+            << "(backend pid" << *backendPid << ")";
+    return true;
+}
+
+bool DatabaseConnectionPool::isHealthy(const QString &connectionName) const
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    if (!db.isOpen()) {
+        return false;
+    }
+    QSqlQuery query(db);
+    return query.exec("SELECT 1");
+}
+
+void DatabaseConnectionPool::removeConnection(const QString &connectionName)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+        if (db.isOpen()) {
+            db.close();
+        }
+    } // Копія QSqlDatabase має бути знищена до removeDatabase
+    QSqlDatabase::removeDatabase(connectionName);
+}
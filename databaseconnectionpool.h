@@ -0,0 +1,66 @@
+#ifndef DATABASECONNECTIONPOOL_H
+#define DATABASECONNECTIONPOOL_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QString>
+#include <QWaitCondition>
+#include "database.h"
+
+class QThread;
+
+// Обмежений пул з'єднань PostgreSQL.
+// QSqlDatabase можна використовувати лише в потоці, який його створив, тому пул
+// видає кожному потоку власне з'єднання, відкрите з одного спільного конфігу.
+// Кількість одночасно відкритих з'єднань обмежена maxSize: якщо ліміт вичерпано,
+// acquire() чекає, доки інший потік не звільнить своє з'єднання.
+class DatabaseConnectionPool
+{
+public:
+    explicit DatabaseConnectionPool(const DatabaseConnectionConfig &config, int maxSize = 4);
+    ~DatabaseConnectionPool();
+
+    // Повертає з'єднання поточного потоку (відкриває нове за потреби).
+    // Якщо з'єднання довго не використовувалось, перед видачею перевіряється "SELECT 1".
+    QSqlDatabase acquire(int timeoutMs = 5000);
+    // Чи перевірить acquire() з'єднання поточного потоку (і, можливо, перевідкриє його під тим самим
+    // ім'ям): власник має заздалегідь відпустити свої копії QSqlDatabase та підготовлені запити
+    bool healthCheckDue() const;
+    // Позначає з'єднання поточного потоку як вільне (для обліку простою)
+    void release();
+    // Закриває з'єднання поточного потоку, якщо воно простоює довше idleTimeoutMs
+    bool closeIfIdle(int idleTimeoutMs);
+    // Закриває з'єднання поточного потоку і звільняє місце в пулі
+    void closeCurrentThreadConnection();
+
+    void setHealthCheckInterval(int ms);
+    int maxSize() const;
+    int openConnections() const;
+    // Чи належить серверний процес (pg_backend_pid) одному з відкритих з'єднань пулу —
+    // так сповіщення про зміни, зроблені фоновими потоками, відрізняються від чужих
+    bool ownsBackendPid(int backendPid) const;
+
+private:
+    struct Entry {
+        QString connectionName;
+        qint64 lastUsedMs = 0;
+        bool inUse = false;
+        int backendPid = 0;
+    };
+
+    bool openConnection(const QString &connectionName, int *backendPid);
+    bool isHealthy(const QString &connectionName) const;
+    static void removeConnection(const QString &connectionName);
+
+    const DatabaseConnectionConfig m_config;
+    const int m_maxSize;
+    int m_healthCheckIntervalMs = 30000;
+    int m_nextConnectionId = 0;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_slotFreed;
+    QHash<QThread *, Entry> m_entries;
+};
+
+#endif // DATABASECONNECTIONPOOL_H
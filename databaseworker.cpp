@@ -0,0 +1,73 @@
+#include "databaseworker.h"
+#include "databaseconnectionpool.h"
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+
+DatabaseWorker::DatabaseWorker(DatabaseConnectionPool *pool, int idleTimeoutMs, QObject *parent)
+    : QObject(parent)
+    , m_pool(pool)
+    , m_idleTimeoutMs(idleTimeoutMs)
+{
+}
+
+DatabaseWorker::~DatabaseWorker()
+{
+    // Знищується у своєму потоці (deleteLater після QThread::finished),
+    // тому з'єднання закривається там само, де було відкрите.
+    delete m_manager;
+    m_manager = nullptr;
+    if (m_pool) {
+        m_pool->closeCurrentThreadConnection();
+    }
+}
+
+void DatabaseWorker::initialize()
+{
+    if (m_manager) {
+        return;
+    }
+
+    m_manager = new DatabaseManager();
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setTimerType(Qt::PreciseTimer);
+    m_idleTimer->setInterval(m_idleTimeoutMs);
+    connect(m_idleTimer, &QTimer::timeout, this, &DatabaseWorker::releaseIdleConnection);
+    qInfo() << "DatabaseWorker: ініціалізовано у потоці" << QThread::currentThread();
+}
+
+void DatabaseWorker::runTask(const std::function<void(DatabaseManager *)> &task)
+{
+    if (!m_manager) {
+        initialize();
+    }
+    m_idleTimer->stop();
+
+    // Після перевірки пул може перевідкрити з'єднання під тим самим ім'ям; як і в
+    // releaseIdleConnection(), копія менеджера та його підготовлені запити відпускаються раніше
+    if (m_pool->healthCheckDue()) {
+        m_manager->closeConnection();
+    }
+    QSqlDatabase db = m_pool->acquire();
+    if (!db.isValid() || !db.isOpen()) {
+        qWarning() << "DatabaseWorker: з'єднання з пулу недоступне, завдання виконується без підключення.";
+    }
+    m_manager->adoptConnection(db);
+
+    task(m_manager);
+
+    m_pool->release();
+    m_pendingTasks.deref();
+    m_idleTimer->start();
+}
+
+void DatabaseWorker::releaseIdleConnection()
+{
+    if (!m_manager) {
+        return;
+    }
+    // Спершу відпускаємо копію QSqlDatabase у менеджері, інакше removeDatabase попередить про активне використання
+    m_manager->closeConnection();
+    m_pool->closeIfIdle(m_idleTimeoutMs);
+}
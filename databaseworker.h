@@ -0,0 +1,45 @@
+#ifndef DATABASEWORKER_H
+#define DATABASEWORKER_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <functional>
+#include "database.h"
+
+class QTimer;
+class DatabaseConnectionPool;
+
+// Об'єкт, що живе у фоновому потоці та володіє власним DatabaseManager.
+// З'єднання береться з DatabaseConnectionPool на час виконання завдання і
+// закривається, якщо потік довго простоює. Завдання виконуються послідовно
+// у тому потоці, в який об'єкт переміщено через moveToThread().
+class DatabaseWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DatabaseWorker(DatabaseConnectionPool *pool, int idleTimeoutMs = 60000, QObject *parent = nullptr);
+    ~DatabaseWorker();
+
+    // Викликається лише з потоку воркера
+    void runTask(const std::function<void(DatabaseManager *)> &task);
+
+    // Потокобезпечні лічильники для вибору найменш завантаженого воркера
+    void markTaskQueued() { m_pendingTasks.ref(); }
+    int pendingTasks() const { return m_pendingTasks.loadRelaxed(); }
+
+public slots:
+    void initialize();
+
+private slots:
+    void releaseIdleConnection();
+
+private:
+    DatabaseConnectionPool *m_pool = nullptr;
+    DatabaseManager *m_manager = nullptr;
+    QTimer *m_idleTimer = nullptr;
+    int m_idleTimeoutMs;
+    QAtomicInt m_pendingTasks;
+};
+
+#endif // DATABASEWORKER_H
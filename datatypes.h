@@ -15,7 +15,18 @@ struct BookDisplayInfo {
     QString coverImagePath;
     int stockQuantity;
     QString genre;
+    int ratingSum = 0;   // Сума оцінок 1-5 (book.rating_sum)
+    int ratingCount = 0; // Кількість оцінок (book.rating_count)
     bool found = false;
+
+    double averageRating() const { return ratingCount > 0 ? static_cast<double>(ratingSum) / ratingCount : 0.0; }
+};
+
+// Рядок book зі сповіщення про зміну (DatabaseManager::bookChanged): колонки, які тримає CatalogSnapshot
+struct BookChangeInfo {
+    BookDisplayInfo book;
+    QString language;
+    int ratingAvgCents = 0; // book.rating_avg * 100
 };
 
 struct AuthorDisplayInfo {
@@ -51,6 +62,7 @@ struct BookDetailsInfo {
 };
 
 struct CommentDisplayInfo {
+    int commentId = 0;
     QString authorName;
     QDateTime commentDate;
     int rating;
@@ -128,11 +140,29 @@ struct AuthorDetailsInfo {
 };
 
 struct BookFilterCriteria {
+    enum class SortOrder { Title, Rating };
+
     QStringList genres;
     QStringList languages;
     double minPrice = -1.0;
     double maxPrice = -1.0;
     bool inStockOnly = false;
+    SortOrder sortOrder = SortOrder::Title; // Rating — за середньою оцінкою (book.rating_avg), від найвищої
+};
+
+// Курсор для посторінкового (keyset) завантаження каталогу: ключ сортування останньої показаної книги
+// ((title, book_id) або (rating_avg, book_id) залежно від BookFilterCriteria::sortOrder)
+struct BookPageCursor {
+    QString afterTitle;
+    QString afterRating; // rating_avg у текстовому вигляді NUMERIC, щоб порівняння було точним
+    int afterBookId = 0;
+    bool isStart() const { return afterBookId <= 0; }
+};
+
+struct BookPage {
+    QList<BookDisplayInfo> books;
+    BookPageCursor nextCursor;
+    bool hasMore = false;
 };
 
 #endif // DATATYPES_H
@@ -0,0 +1,110 @@
+#include "keyedwidgetlist.h"
+#include <QBoxLayout>
+#include <QGridLayout>
+#include <QLabel>
+#include <QLayout>
+#include <QSet>
+#include <QSpacerItem>
+
+bool KeyedWidgetList::setLabelText(QLabel *label, const QString &text)
+{
+    if (!label || label->text() == text) return false;
+    label->setText(text);
+    return true;
+}
+
+QList<QWidget *> KeyedWidgetList::widgets() const
+{
+    QList<QWidget *> result;
+    result.reserve(m_ordered.size());
+    for (const QPointer<QWidget> &widget : m_ordered) {
+        if (widget) result.append(widget.data());
+    }
+    return result;
+}
+
+void KeyedWidgetList::clear()
+{
+    for (const QPointer<QWidget> &widget : std::as_const(m_widgets)) {
+        if (widget) disposeWidget(widget);
+    }
+    m_widgets.clear();
+    m_ordered.clear();
+}
+
+// Віджет може бути відправником сигналу, який зараз обробляється (кнопка "Видалити" в кошику),
+// тому знищення відкладається до повернення в цикл подій
+void KeyedWidgetList::disposeWidget(QWidget *widget)
+{
+    widget->hide();
+    widget->setParent(nullptr);
+    widget->deleteLater();
+}
+
+void KeyedWidgetList::detachLayoutItems(QLayout *layout, const QList<QWidget *> &keep)
+{
+    const QSet<QWidget *> keepSet(keep.constBegin(), keep.constEnd());
+    QLayoutItem *item;
+    while ((item = layout->takeAt(0)) != nullptr) {
+        QWidget *widget = item->widget();
+        if (widget && !keepSet.contains(widget)) {
+            disposeWidget(widget);
+        }
+        delete item; // Сам віджет лишається живим, видаляється лише QLayoutItem
+    }
+}
+
+void KeyedWidgetList::placeInBoxLayout(QBoxLayout *layout, const QList<QWidget *> &widgets)
+{
+    if (!layout) return;
+    detachLayoutItems(layout, widgets);
+    if (widgets.isEmpty()) return;
+    for (QWidget *widget : widgets) {
+        layout->addWidget(widget);
+        widget->show();
+    }
+    layout->addSpacerItem(new QSpacerItem(20, 1, QSizePolicy::Minimum, QSizePolicy::Expanding));
+}
+
+void KeyedWidgetList::layoutGrid(QGridLayout *layout, int numColumns)
+{
+    m_gridColumns = qMax(1, numColumns);
+    placeInGridLayout(layout, widgets(), m_gridColumns);
+}
+
+bool KeyedWidgetList::relayoutGrid(QGridLayout *layout, int numColumns)
+{
+    numColumns = qMax(1, numColumns);
+    if (numColumns == m_gridColumns) return false;
+    const QList<QWidget *> current = widgets();
+    if (current.isEmpty()) return false; // Заглушка порожнього списку не потребує перестановки
+    m_gridColumns = numColumns;
+    placeInGridLayout(layout, current, numColumns);
+    return true;
+}
+
+void KeyedWidgetList::placeInGridLayout(QGridLayout *layout, const QList<QWidget *> &widgets, int numColumns)
+{
+    if (!layout) return;
+    numColumns = qMax(1, numColumns);
+    detachLayoutItems(layout, widgets);
+    if (widgets.isEmpty()) return;
+
+    int row = 0;
+    int col = 0;
+    for (QWidget *widget : widgets) {
+        layout->addWidget(widget, row, col);
+        widget->show();
+        if (++col >= numColumns) {
+            col = 0;
+            ++row;
+        }
+    }
+
+    // Add horizontal spacer to push items to the left
+    if (col > 0) {
+        layout->addItem(new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Minimum), row, col, 1, numColumns - col);
+    }
+    // Add vertical spacer to push items to the top
+    layout->addItem(new QSpacerItem(1, 1, QSizePolicy::Minimum, QSizePolicy::Expanding), row + (col == 0 ? 0 : 1), 0, 1, numColumns);
+}
@@ -0,0 +1,104 @@
+#ifndef KEYEDWIDGETLIST_H
+#define KEYEDWIDGETLIST_H
+
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QWidget>
+
+class QBoxLayout;
+class QGridLayout;
+class QLabel;
+class QLayout;
+
+// Узгодження (reconciliation) списку карток з новими даними за ключем (ID сутності).
+// Картки, чий ключ залишився, перевикористовуються і лише оновлюються (update), нові —
+// створюються (create), зниклі — видаляються. Тож повторне відображення коштує
+// пропорційно кількості змін, а не розміру списку.
+//
+// Віджети зберігаються через QPointer: якщо layout очистили в обхід списку (clearLayout),
+// відповідні ключі просто створяться заново.
+class KeyedWidgetList
+{
+public:
+    // keyOf(item) -> int, create(item) -> QWidget*, update(QWidget*, item).
+    // Повертає віджети в порядку items; розміщення в layout — placeInBoxLayout/placeInGridLayout.
+    template <typename Item, typename KeyOf, typename Create, typename Update>
+    QList<QWidget *> reconcile(const QList<Item> &items, KeyOf keyOf, Create create, Update update)
+    {
+        QHash<int, QPointer<QWidget>> next;
+        next.reserve(items.size());
+        m_ordered.clear();
+        m_ordered.reserve(items.size());
+        m_lastCreated = 0;
+        m_lastReused = 0;
+
+        for (const Item &item : items) {
+            const int key = keyOf(item);
+            if (next.contains(key)) {
+                continue; // Дублікат ключа — картка вже є
+            }
+            QWidget *widget = m_widgets.take(key).data();
+            if (widget) {
+                update(widget, item);
+                ++m_lastReused;
+            } else {
+                widget = create(item);
+                if (!widget) continue;
+                ++m_lastCreated;
+            }
+            next.insert(key, widget);
+            m_ordered.append(widget);
+        }
+
+        m_lastRemoved = 0;
+        for (const QPointer<QWidget> &stale : std::as_const(m_widgets)) {
+            if (stale) {
+                disposeWidget(stale);
+                ++m_lastRemoved;
+            }
+        }
+        m_widgets = std::move(next);
+        return widgets();
+    }
+
+    // Поточні картки в порядку останнього reconcile (без уже знищених)
+    QList<QWidget *> widgets() const;
+    QWidget *widget(int key) const { return m_widgets.value(key).data(); }
+    void clear();
+
+    int lastCreated() const { return m_lastCreated; }
+    int lastReused() const { return m_lastReused; }
+    int lastRemoved() const { return m_lastRemoved; }
+
+    // Змінює текст мітки лише якщо він відрізняється (без зайвих перерахунків розміру)
+    static bool setLabelText(QLabel *label, const QString &text);
+
+    // Переставляє віджети в layout без їх перестворення. Усе інше, що було в layout
+    // (заглушки, спейсери), прибирається; у кінці додається вертикальний спейсер.
+    // Для порожнього списку layout лише очищується — заглушку додає викликач.
+    static void placeInBoxLayout(QBoxLayout *layout, const QList<QWidget *> &widgets);
+    // Розкладає віджети сіткою по numColumns стовпців, з горизонтальним спейсером в неповному
+    // рядку та вертикальним під сіткою.
+    static void placeInGridLayout(QGridLayout *layout, const QList<QWidget *> &widgets, int numColumns);
+
+    // Розкладає поточні картки сіткою та запам'ятовує кількість стовпців
+    void layoutGrid(QGridLayout *layout, int numColumns);
+    // Для зміни розміру вікна: наявні картки лише переставляються і тільки тоді,
+    // коли змінилася кількість стовпців. Повертає true, якщо розкладку змінено.
+    bool relayoutGrid(QGridLayout *layout, int numColumns);
+    int gridColumns() const { return m_gridColumns; }
+
+private:
+    static void detachLayoutItems(QLayout *layout, const QList<QWidget *> &keep);
+    static void disposeWidget(QWidget *widget);
+
+    QHash<int, QPointer<QWidget>> m_widgets;
+    QList<QPointer<QWidget>> m_ordered;
+    int m_lastCreated = 0;
+    int m_lastReused = 0;
+    int m_lastRemoved = 0;
+    int m_gridColumns = 0;
+};
+
+#endif // KEYEDWIDGETLIST_H
@@ -1,10 +1,12 @@
 #include <QApplication>
 #include <QDebug>
 #include <QMessageBox>
+#include <QCommandLineParser>
 #include "mainwindow.h"
 #include "logindialog.h"
 #include "database.h"
 #include "testdata.h"
+#include "checkoutstress.h"
 
 int main(int argc, char *argv[])
 {
@@ -14,6 +16,25 @@ int main(int argc, char *argv[])
     QApplication::setOrganizationName("Patsera_Ihor");
     QApplication::setApplicationVersion("1.0");
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("Книжковий магазин"));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption checkoutStressOption("checkout-stress",
+        QObject::tr("Навантажувальний тест оформлення замовлень замість запуску GUI: <orders> замовлень (створюються по-справжньому!)."),
+        QObject::tr("orders"));
+    QCommandLineOption stressConcurrencyOption("stress-concurrency",
+        QObject::tr("Кількість паралельних кас для --checkout-stress (за замовчуванням 8)."), QObject::tr("n"), "8");
+    QCommandLineOption stressHotBooksOption("stress-hot-books",
+        QObject::tr("Кількість спільних книг у кошиках для --checkout-stress (за замовчуванням 3)."), QObject::tr("n"), "3");
+    QCommandLineOption stressCustomerOption("stress-customer",
+        QObject::tr("ID покупця для замовлень --checkout-stress (за замовчуванням 1)."), QObject::tr("id"), "1");
+    parser.addOption(checkoutStressOption);
+    parser.addOption(stressConcurrencyOption);
+    parser.addOption(stressHotBooksOption);
+    parser.addOption(stressCustomerOption);
+    parser.process(a);
+
     DatabaseManager dbManager;
 
     bool connected = dbManager.connectToDatabase(
@@ -31,6 +52,29 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (!dbManager.upgradeSchema()) {
+        qWarning() << "Не вдалося оновити схему БД до поточної версії.";
+    }
+
+    // Відсутні вторинні індекси (sql/indexes.sql) створюються до відкриття вікон
+    if (!dbManager.verifyIndexes()) {
+        qWarning() << "Не всі індекси вдалося перевірити або створити; запити можуть працювати повільніше.";
+    }
+
+    // Зміни з інших кас (залишки, коментарі, статуси, кошик) надходять як сигнали DatabaseManager
+    if (!dbManager.startChangeNotifications()) {
+        qWarning() << "Сповіщення про зміни недоступні; дані оновлюватимуться лише під час навігації.";
+    }
+
+    if (parser.isSet(checkoutStressOption)) {
+        CheckoutStressOptions stressOptions;
+        stressOptions.orders = parser.value(checkoutStressOption).toInt();
+        stressOptions.concurrency = parser.value(stressConcurrencyOption).toInt();
+        stressOptions.hotBooks = parser.value(stressHotBooksOption).toInt();
+        stressOptions.customerId = parser.value(stressCustomerOption).toInt();
+        const CheckoutStressResult stressResult = CheckoutStress::run(&dbManager, stressOptions);
+        return stressResult.attempted > 0 ? 0 : 1;
+    }
 
     LoginDialog loginDialog(&dbManager);
     int loggedInUserId = -1;
@@ -24,11 +24,17 @@
 #include <QComboBox>
 #include <QLineEdit>
 #include <QCompleter>
+#include <QScrollBar>
 #include <QStringListModel>
 #include <QListView>
 #include <QMouseEvent>
 #include <QTextEdit>
 #include "starratingwidget.h"
+#include "bookgridmodel.h"
+#include "coverimagecache.h"
+#include "queryresultcache.h"
+#include "asyncimageloader.h"
+#include "bookcarddelegate.h"
 #include <QCoreApplication>
 #include <QDir>
 #include <QHeaderView>
@@ -182,23 +188,24 @@ MainWindow::MainWindow(DatabaseManager *dbManager, int customerId, QWidget *pare
 
 
     qInfo() << "Завантаження даних для головної сторінки...";
-    if (ui->classicsRowLayout) {
-        QList<BookDisplayInfo> classicsBooks = m_dbManager->getBooksByGenre("Класика", 8);
-        displayBooksInHorizontalLayout(classicsBooks, ui->classicsRowLayout);
-    } else {
-        qWarning() << "classicsRowLayout is null!";
-    }
-    if (ui->fantasyRowLayout) {
-        QList<BookDisplayInfo> fantasyBooks = m_dbManager->getBooksByGenre("Фентезі", 8);
-        displayBooksInHorizontalLayout(fantasyBooks, ui->fantasyRowLayout);
-    } else {
-        qWarning() << "fantasyRowLayout is null!";
-    }
-    if (ui->nonFictionRowLayout) {
-        QList<BookDisplayInfo> nonFictionBooks = m_dbManager->getBooksByGenre("Науково-популярне", 8);
-        displayBooksInHorizontalLayout(nonFictionBooks, ui->nonFictionRowLayout);
-    } else {
-        qWarning() << "nonFictionRowLayout is null!";
+    // Рядки жанрів завантажуються у фоновому потоці, щоб не блокувати запуск вікна
+    const QList<QPair<QString, QHBoxLayout*>> genreRows = {
+        { QStringLiteral("Класика"), ui->classicsRowLayout },
+        { QStringLiteral("Фентезі"), ui->fantasyRowLayout },
+        { QStringLiteral("Науково-популярне"), ui->nonFictionRowLayout }
+    };
+    for (const auto &genreRow : genreRows) {
+        QHBoxLayout *rowLayout = genreRow.second;
+        if (!rowLayout) {
+            qWarning() << "Row layout for genre" << genreRow.first << "is null!";
+            continue;
+        }
+        QPointer<QHBoxLayout> rowGuard(rowLayout);
+        m_dbManager->getBooksByGenreAsync(genreRow.first, 8, this, [this, rowGuard](const QList<BookDisplayInfo> &books) {
+            if (rowGuard) {
+                displayBooksInHorizontalLayout(books, rowGuard);
+            }
+        });
     }
     qInfo() << "Завершено завантаження даних для головної сторінки.";
 
@@ -262,13 +269,15 @@ MainWindow::MainWindow(DatabaseManager *dbManager, int customerId, QWidget *pare
     if (!ui->authorsContainerLayout) {
         qCritical() << "authorsContainerLayout is null!";
     } else {
-        QList<AuthorDisplayInfo> authors = m_dbManager->getAllAuthorsForDisplay();
-        displayAuthors(authors);
-        if (!authors.isEmpty()) {
-             qInfo() << "Автори успішно завантажені.";
-        } else {
-             qWarning() << "Не вдалося завантажити авторів.";
-        }
+        // Виконується паралельно з рядками жанрів — кожен запит отримує своє з'єднання з пулу
+        m_dbManager->getAllAuthorsForDisplayAsync(this, [this](const QList<AuthorDisplayInfo> &authors) {
+            displayAuthors(authors);
+            if (!authors.isEmpty()) {
+                 qInfo() << "Автори успішно завантажені.";
+            } else {
+                 qWarning() << "Не вдалося завантажити авторів.";
+            }
+        });
     }
 
     setProfileEditingEnabled(false);
@@ -277,6 +286,8 @@ MainWindow::MainWindow(DatabaseManager *dbManager, int customerId, QWidget *pare
 
     setupAutoBanner();
 
+    setupBookSimilarityRebuild();
+
     connect(ui->sendCommentButton, &QPushButton::clicked, this, &MainWindow::on_sendCommentButton_clicked);
 
     setupFilterPanel();
@@ -286,17 +297,40 @@ MainWindow::MainWindow(DatabaseManager *dbManager, int customerId, QWidget *pare
     m_filterApplyTimer->setInterval(750);
     connect(m_filterApplyTimer, &QTimer::timeout, this, &MainWindow::applyFiltersWithDelay);
 
+    m_cartFlushTimer = new QTimer(this);
+    m_cartFlushTimer->setSingleShot(true);
+    m_cartFlushTimer->setInterval(1500);
+    connect(m_cartFlushTimer, &QTimer::timeout, this, [this]() { flushCartChanges(); });
+    connect(ui->contentStackedWidget, &QStackedWidget::currentChanged, this, [this]() { flushCartChanges(); });
 
     loadCartFromDatabase();
 
-    QScrollArea* booksScrollArea = ui->booksPage->findChild<QScrollArea*>();
-    if (booksScrollArea) {
-        booksScrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-        booksScrollArea->setWidgetResizable(true);
-        qInfo() << "Books page ScrollArea horizontal scrollbar disabled.";
-    } else {
-        qWarning() << "Could not find QScrollArea on the books page!";
-    }
+    // Сітка книг: модель завантажує каталог сторінками, делегат малює лише видимі картки
+    m_bookGridModel = new BookGridModel(m_dbManager, this);
+    m_bookCardDelegate = new BookCardDelegate(this);
+    ui->booksListView->setModel(m_bookGridModel);
+    ui->booksListView->setItemDelegate(m_bookCardDelegate);
+    ui->booksListView->setMouseTracking(true); // Для підсвічування картки під курсором
+    connect(m_bookCardDelegate, &BookCardDelegate::bookClicked, this, &MainWindow::showBookDetails);
+    connect(m_bookCardDelegate, &BookCardDelegate::addToCartClicked, this, &MainWindow::on_addToCartButtonClicked);
+    // Обкладинки декодуються у фоні: після готовності перемальовуємо видимі картки,
+    // а при прокручуванні скасовуємо завантаження карток, що вже не видно
+    connect(AsyncImageLoader::instance(), &AsyncImageLoader::pixmapReady, ui->booksListView->viewport(), QOverload<>::of(&QWidget::update));
+    connect(ui->booksListView->verticalScrollBar(), &QScrollBar::valueChanged, this, [this]() {
+        m_bookCardDelegate->cancelInvisibleLoads(ui->booksListView);
+    });
+    connect(m_bookGridModel, &QAbstractItemModel::modelReset, m_bookCardDelegate, &BookCardDelegate::cancelAllLoads);
+    connect(m_bookGridModel, &BookGridModel::firstPageLoaded, this, [this](int count) {
+        if (count > 0) {
+             ui->statusBar->showMessage(tr("Книги успішно завантажено."), 4000);
+        } else {
+             qInfo() << "No books found matching the current filters.";
+             ui->statusBar->showMessage(tr("Книг за вашим запитом не знайдено."), 4000);
+        }
+    });
+    // Поки знімок каталогу не завантажено, фільтри виконуються запитами до БД
+    refreshCatalogSnapshot();
+    setupChangeNotifications();
 
     QScrollArea* authorsScrollArea = ui->authorsPage->findChild<QScrollArea*>();
     if (authorsScrollArea) {
@@ -376,6 +410,11 @@ MainWindow::MainWindow(DatabaseManager *dbManager, int customerId, QWidget *pare
 
 MainWindow::~MainWindow()
 {
+    flushCartChanges();
+    const QueryResultCache::Stats cacheStats = QueryResultCache::instance().stats();
+    qInfo() << "Query result cache: hits" << cacheStats.hits << "misses" << cacheStats.misses
+            << "expired" << cacheStats.expired << "invalidated" << cacheStats.invalidated
+            << QString("hit rate %1%").arg(cacheStats.hitRate() * 100.0, 0, 'f', 1);
     if (m_dbManager) {
         m_dbManager->closeConnection();
     }
@@ -544,6 +583,7 @@ void MainWindow::setupFilterPanel()
     m_minPriceValueLabel = ui->filterPanel->findChild<QLabel*>("minPriceValueLabel");
     m_maxPriceValueLabel = ui->filterPanel->findChild<QLabel*>("maxPriceValueLabel");
     m_inStockFilterCheckBox = ui->filterPanel->findChild<QCheckBox*>("inStockFilterCheckBox");
+    m_sortOrderComboBox = ui->filterPanel->findChild<QComboBox*>("sortOrderComboBox");
     QPushButton *applyButton = ui->filterPanel->findChild<QPushButton*>("applyFiltersButton");
     QPushButton *resetButton = ui->filterPanel->findChild<QPushButton*>("resetFiltersButton");
 
@@ -607,6 +647,9 @@ void MainWindow::setupFilterPanel()
     if (m_inStockFilterCheckBox) {
         connect(m_inStockFilterCheckBox, &QCheckBox::stateChanged, this, &MainWindow::onFilterCriteriaChanged);
     }
+    if (m_sortOrderComboBox) {
+        connect(m_sortOrderComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onFilterCriteriaChanged);
+    }
 
 
     if (m_dbManager) {
@@ -857,12 +900,19 @@ void MainWindow::applyFilters()
         m_currentFilterCriteria.inStockOnly = m_inStockFilterCheckBox->isChecked();
     }
 
+    if (m_sortOrderComboBox) {
+        m_currentFilterCriteria.sortOrder = m_sortOrderComboBox->currentIndex() == 1
+                ? BookFilterCriteria::SortOrder::Rating
+                : BookFilterCriteria::SortOrder::Title;
+    }
+
     qInfo() << "Applying filters:"
             << "Genres:" << m_currentFilterCriteria.genres
             << "Languages:" << m_currentFilterCriteria.languages
             << "MinPrice:" << m_currentFilterCriteria.minPrice
             << "MaxPrice:" << m_currentFilterCriteria.maxPrice
-            << "InStockOnly:" << m_currentFilterCriteria.inStockOnly;
+            << "InStockOnly:" << m_currentFilterCriteria.inStockOnly
+            << "SortByRating:" << (m_currentFilterCriteria.sortOrder == BookFilterCriteria::SortOrder::Rating);
 
     loadAndDisplayFilteredBooks();
 
@@ -896,6 +946,9 @@ void MainWindow::resetFilters()
     if (m_inStockFilterCheckBox) {
         m_inStockFilterCheckBox->setChecked(false);
     }
+    if (m_sortOrderComboBox) {
+        m_sortOrderComboBox->setCurrentIndex(0);
+    }
 
     if (m_filterApplyTimer && m_filterApplyTimer->isActive()) {
         m_filterApplyTimer->stop();
@@ -914,31 +967,15 @@ void MainWindow::resetFilters()
 
 void MainWindow::loadAndDisplayFilteredBooks()
 {
-    if (!m_dbManager) {
-        qWarning() << "Cannot load books: DatabaseManager is null.";
-        if (ui->booksContainerLayout) {
-            clearLayout(ui->booksContainerLayout);
-            QLabel *errorLabel = new QLabel(tr("Помилка: Немає доступу до бази даних."), ui->booksContainerWidget);
-            ui->booksContainerLayout->addWidget(errorLabel);
-        }
-        return;
-    }
-    if (!ui->booksContainerLayout || !ui->booksContainerWidget) {
-        qCritical() << "Cannot display books: booksContainerLayout or booksContainerWidget is null!";
+    if (!m_dbManager || !m_bookGridModel) {
+        qWarning() << "Cannot load books: DatabaseManager or book model is null.";
+        ui->statusBar->showMessage(tr("Помилка: Немає доступу до бази даних."), 5000);
         return;
     }
 
     qInfo() << "Loading books with current filters...";
-    QList<BookDisplayInfo> books = m_dbManager->getFilteredBooksForDisplay(m_currentFilterCriteria);
-
-    displayBooks(books, ui->booksContainerLayout, ui->booksContainerWidget);
-
-    if (!books.isEmpty()) {
-         ui->statusBar->showMessage(tr("Книги успішно завантажено (%1 знайдено).").arg(books.size()), 4000);
-    } else {
-         qInfo() << "No books found matching the current filters.";
-         ui->statusBar->showMessage(tr("Книг за вашим запитом не знайдено."), 4000);
-    }
+    // Модель скидається і завантажує першу сторінку; наступні догружаються при прокрутці
+    m_bookGridModel->setFilterCriteria(m_currentFilterCriteria);
 }
 
 void MainWindow::onFilterCriteriaChanged()
@@ -1069,13 +1106,15 @@ void MainWindow::resizeEvent(QResizeEvent *event)
 
     updateBannerImages();
 
-    if (ui->contentStackedWidget && ui->contentStackedWidget->currentWidget() == ui->booksPage) {
-        qDebug() << "Books page is active, triggering layout update via loadAndDisplayFilteredBooks().";
-        loadAndDisplayFilteredBooks();
-    }
-    else if (ui->contentStackedWidget && ui->contentStackedWidget->currentWidget() == ui->authorsPage) {
-        qDebug() << "Authors page is active, triggering layout update via loadAndDisplayAuthors().";
-        loadAndDisplayAuthors();
+    // Сітка книг (QListView, resizeMode Adjust) перерозкладає картки сама — перезавантаження не потрібне.
+    // Сітки карток авторів і книг автора лише переставляються при зміні кількості стовпців:
+    // без перестворення віджетів і без запитів до БД
+    if (!ui->contentStackedWidget) return;
+    QWidget *currentPage = ui->contentStackedWidget->currentWidget();
+    if (currentPage == ui->authorsPage) {
+        relayoutAuthorsGrid();
+    } else if (currentPage == ui->authorDetailsPage) {
+        relayoutBooksGrid(ui->authorBooksLayout, ui->authorBooksContainerWidget);
     }
 }
 
@@ -1120,12 +1159,12 @@ void MainWindow::populateAuthorDetailsPage(const AuthorDetailsInfo &details)
         return;
     }
 
-    QPixmap photoPixmap(details.imagePath);
-    if (photoPixmap.isNull() || details.imagePath.isEmpty()) {
+    const QPixmap photoPixmap = CoverImageCache::instance().pixmap(details.imagePath, ui->authorDetailPhotoLabel->size(), Qt::KeepAspectRatioByExpanding);
+    if (photoPixmap.isNull()) {
         ui->authorDetailPhotoLabel->setText(tr("👤"));
         ui->authorDetailPhotoLabel->setStyleSheet("QLabel { background-color: #e0e0e0; color: #555; border-radius: 90px; font-size: 80pt; qproperty-alignment: AlignCenter; border: 1px solid #ccc; }");
     } else {
-        QPixmap scaledPixmap = photoPixmap.scaled(ui->authorDetailPhotoLabel->size(), Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+        QPixmap scaledPixmap = photoPixmap;
         QBitmap mask(scaledPixmap.size());
         mask.fill(Qt::color0);
         QPainter painter(&mask);
@@ -1162,6 +1201,108 @@ void MainWindow::populateAuthorDetailsPage(const AuthorDetailsInfo &details)
     qInfo() << "Author details page populated for:" << details.firstName << details.lastName;
 }
 
+// Точкові оновлення за сповіщеннями з БД (LISTEN/NOTIFY): перезавантажується лише те,
+// що зачіпає зміна і що зараз видно користувачу
+void MainWindow::setupChangeNotifications()
+{
+    if (!m_dbManager) {
+        return;
+    }
+
+    m_catalogChangeTimer = new QTimer(this);
+    m_catalogChangeTimer->setSingleShot(true);
+    m_catalogChangeTimer->setInterval(1000);
+    connect(m_catalogChangeTimer, &QTimer::timeout, this, &MainWindow::refreshCatalogSnapshot);
+
+    m_catalogPatchTimer = new QTimer(this);
+    m_catalogPatchTimer->setSingleShot(true);
+    m_catalogPatchTimer->setInterval(200);
+    connect(m_catalogPatchTimer, &QTimer::timeout, this, &MainWindow::applyCatalogPatches);
+
+    m_cartChangeTimer = new QTimer(this);
+    m_cartChangeTimer->setSingleShot(true);
+    m_cartChangeTimer->setInterval(500);
+    connect(m_cartChangeTimer, &QTimer::timeout, this, &MainWindow::loadCartFromDatabase);
+
+    connect(m_dbManager, &DatabaseManager::authorChanged, this,
+            [this](const AuthorDisplayInfo &author, DatabaseManager::ChangeOperation operation) {
+        if (operation == DatabaseManager::ChangeOperation::Delete) {
+            m_searchIndex.removeEntry(SearchSuggestionInfo::Author, author.authorId);
+        } else if (operation == DatabaseManager::ChangeOperation::Insert) {
+            refreshSearchIndex();
+        } else {
+            SearchSuggestionInfo entry;
+            entry.type = SearchSuggestionInfo::Author;
+            entry.id = author.authorId;
+            entry.displayText = author.firstName + ' ' + author.lastName; // Як у GetSearchIndexEntries
+            entry.imagePath = author.imagePath;
+            m_searchIndex.updateEntry(entry);
+        }
+    });
+
+    connect(m_dbManager, &DatabaseManager::bookChanged, this,
+            [this](const BookChangeInfo &change, DatabaseManager::ChangeOperation operation) {
+        const int bookId = change.book.bookId;
+        if (operation == DatabaseManager::ChangeOperation::Delete) {
+            m_searchIndex.removeEntry(SearchSuggestionInfo::Book, bookId);
+        } else if (operation == DatabaseManager::ChangeOperation::Insert) {
+            refreshSearchIndex();
+        } else {
+            // Назва могла змінитися — підказки мають знаходити книгу за новою
+            SearchSuggestionInfo entry;
+            entry.type = SearchSuggestionInfo::Book;
+            entry.id = bookId;
+            entry.displayText = change.book.title;
+            entry.imagePath = change.book.coverImagePath;
+            entry.price = change.book.price;
+            m_searchIndex.updateEntry(entry);
+        }
+
+        if (m_cartItems.contains(bookId) && operation == DatabaseManager::ChangeOperation::Update) {
+            CartItem &item = m_cartItems[bookId];
+            if (item.book.stockQuantity != change.book.stockQuantity || !qFuzzyCompare(item.book.price, change.book.price)) {
+                item.book.stockQuantity = change.book.stockQuantity;
+                item.book.price = change.book.price;
+                if (ui->contentStackedWidget->currentWidget() == ui->cartPage) {
+                    populateCartPage();
+                }
+            }
+        }
+
+        // Нові та видалені книги змінюють склад каталогу — повне перезавантаження;
+        // зміна рядка (залишок після замовлення, ціна, рейтинг) оновлює знімок на місці
+        if (operation == DatabaseManager::ChangeOperation::Update) {
+            m_pendingCatalogPatches.insert(bookId, change);
+            m_catalogPatchTimer->start();
+        } else {
+            m_catalogChangeTimer->start();
+        }
+    });
+
+    connect(m_dbManager, &DatabaseManager::commentChanged, this,
+            [this](int bookId, int, DatabaseManager::ChangeOperation) {
+        if (bookId == m_currentBookDetailsId && ui->contentStackedWidget->currentWidget() == ui->bookDetailsPage) {
+            refreshBookComments();
+        }
+    });
+
+    connect(m_dbManager, &DatabaseManager::orderStatusChanged, this,
+            [this](int, const QString &, DatabaseManager::ChangeOperation) {
+        if (ui->contentStackedWidget->currentWidget() == ui->ordersPage) {
+            loadAndDisplayOrders();
+        }
+    });
+
+    connect(m_dbManager, &DatabaseManager::cartItemChanged, this,
+            [this](int customerId, int, int, DatabaseManager::ChangeOperation, bool fromThisConnection) {
+        // Власні записи кошика (журнал, видалення оформлених позицій у PlaceOrder, корекція
+        // кількості при завантаженні — у т.ч. з фонових з'єднань) вже відображені в m_cartItems
+        if (customerId == m_currentCustomerId && !fromThisConnection) {
+            m_cartChangeTimer->start();
+        }
+    });
+}
+
 void MainWindow::loadCartFromDatabase()
 {
     if (!m_dbManager) {
@@ -1173,56 +1314,83 @@ void MainWindow::loadCartFromDatabase()
         return;
     }
 
+    flushCartChanges(); // Інакше фонове завантаження прочитає кошик без ще не записаних змін
     qInfo() << "Завантаження корзини з БД для customerId:" << m_currentCustomerId;
-    QMap<int, int> dbCartItems = m_dbManager->getCartItems(m_currentCustomerId);
-
-    m_cartItems.clear();
-
-    if (dbCartItems.isEmpty()) {
-        qInfo() << "Корзина в БД порожня.";
-        updateCartIcon();
-        return;
-    }
+    const int customerId = m_currentCustomerId;
+    // Зміни, зроблені під час завантаження, накладаються на результат (див. queueCartChange);
+    // відповіді попередніх, ще не завершених завантажень відкидаються
+    const int loadGeneration = ++m_cartLoadGeneration;
+    m_cartChangesSinceLoad.clear();
+
+    // Звірка корзини з наявністю на складі виконується у фоновому потоці
+    m_dbManager->runAsync<QMap<int, CartItem>>(this, [customerId](DatabaseManager *db) {
+        QMap<int, CartItem> loadedItems;
+        QMap<int, int> dbCartItems = db->getCartItems(customerId);
+
+        if (dbCartItems.isEmpty()) {
+            qInfo() << "Корзина в БД порожня.";
+            return loadedItems;
+        }
 
-    int itemsLoaded = 0;
-    int itemsSkipped = 0;
-    for (auto it = dbCartItems.constBegin(); it != dbCartItems.constEnd(); ++it) {
-        int bookId = it.key();
-        int quantity = it.value();
-
-        BookDisplayInfo bookInfo = m_dbManager->getBookDisplayInfoById(bookId);
-        if (bookInfo.found) {
-            if (quantity > bookInfo.stockQuantity) {
-                qWarning() << "loadCartFromDatabase: Кількість товару (ID:" << bookId << ") в корзині (" << quantity
-                           << ") перевищує наявну на складі (" << bookInfo.stockQuantity << "). Встановлюємо кількість на" << bookInfo.stockQuantity;
-                quantity = bookInfo.stockQuantity;
-                if (quantity > 0) {
-                    m_dbManager->addOrUpdateCartItem(m_currentCustomerId, bookId, quantity);
-                } else {
-                    m_dbManager->removeCartItem(m_currentCustomerId, bookId);
-                    itemsSkipped++;
-                    continue;
+        int itemsSkipped = 0;
+        for (auto it = dbCartItems.constBegin(); it != dbCartItems.constEnd(); ++it) {
+            int bookId = it.key();
+            int quantity = it.value();
+
+            BookDisplayInfo bookInfo = db->getBookDisplayInfoById(bookId);
+            if (bookInfo.found) {
+                if (quantity > bookInfo.stockQuantity) {
+                    qWarning() << "loadCartFromDatabase: Кількість товару (ID:" << bookId << ") в корзині (" << quantity
+                               << ") перевищує наявну на складі (" << bookInfo.stockQuantity << "). Встановлюємо кількість на" << bookInfo.stockQuantity;
+                    quantity = bookInfo.stockQuantity;
+                    if (quantity > 0) {
+                        db->addOrUpdateCartItem(customerId, bookId, quantity);
+                    } else {
+                        db->removeCartItem(customerId, bookId);
+                        itemsSkipped++;
+                        continue;
+                    }
                 }
-            }
 
-            CartItem newItem;
-            newItem.book = bookInfo;
-            newItem.quantity = quantity;
-            m_cartItems.insert(bookId, newItem);
-            itemsLoaded++;
-        } else {
-            qWarning() << "loadCartFromDatabase: Не вдалося знайти інформацію для книги з ID" << bookId << ", яка є в корзині БД. Видаляємо з корзини БД.";
-            m_dbManager->removeCartItem(m_currentCustomerId, bookId);
-            itemsSkipped++;
+                CartItem newItem;
+                newItem.book = bookInfo;
+                newItem.quantity = quantity;
+                loadedItems.insert(bookId, newItem);
+            } else {
+                qWarning() << "loadCartFromDatabase: Не вдалося знайти інформацію для книги з ID" << bookId << ", яка є в корзині БД. Видаляємо з корзини БД.";
+                db->removeCartItem(customerId, bookId);
+                itemsSkipped++;
+            }
         }
-    }
-
-    qInfo() << "Корзину завантажено з БД. Завантажено:" << itemsLoaded << ", Пропущено/Видалено:" << itemsSkipped;
 
-    updateCartIcon();
-    if (ui->contentStackedWidget->currentWidget() == ui->cartPage) {
-        populateCartPage();
-    }
+        qInfo() << "Корзину завантажено з БД. Завантажено:" << loadedItems.size() << ", Пропущено/Видалено:" << itemsSkipped;
+        return loadedItems;
+    }, [this, customerId, loadGeneration](const QMap<int, CartItem> &loadedItems) {
+        if (customerId != m_currentCustomerId) {
+            return; // Користувач змінився, поки корзина завантажувалась
+        }
+        if (loadGeneration != m_cartLoadGeneration) {
+            return; // Вже запущено новіше завантаження
+        }
+        QMap<int, CartItem> mergedItems = loadedItems;
+        for (auto it = m_cartChangesSinceLoad.constBegin(); it != m_cartChangesSinceLoad.constEnd(); ++it) {
+            if (it.value() <= 0) {
+                mergedItems.remove(it.key());
+            } else if (mergedItems.contains(it.key())) {
+                mergedItems[it.key()].quantity = it.value();
+            } else if (m_cartItems.contains(it.key())) {
+                CartItem item = m_cartItems.value(it.key());
+                item.quantity = it.value();
+                mergedItems.insert(it.key(), item);
+            }
+        }
+        m_cartChangesSinceLoad.clear();
+        m_cartItems = mergedItems;
+        updateCartIcon();
+        if (ui->contentStackedWidget->currentWidget() == ui->cartPage) {
+            populateCartPage();
+        }
+    });
 }
 
 void MainWindow::applyGenreFilter(const QString &genreName)
@@ -15,6 +15,7 @@
 #include <QEvent>
 #include <QEnterEvent>
 #include <QMap>
+#include <QHash>
 #include <QLineEdit>
 #include <QCompleter>
 #include <QStandardItemModel>
@@ -23,20 +24,27 @@
 #include <QSpinBox>
 #include <QScrollArea>
 #include <QTimer>
+#include <QSharedPointer>
+#include <QAtomicInt>
 #include <QStringList>
 #include <QRadioButton>
 #include <QResizeEvent>
 #include "searchsuggestiondelegate.h"
+#include "searchprefixindex.h"
 #include "datatypes.h"
 #include "checkoutdialog.h"
+#include "keyedwidgetlist.h"
 
 
 class CheckoutDialog;
 class DatabaseManager;
 class QListWidget;
 class RangeSlider;
+class BookGridModel;
+class BookCardDelegate;
 class QLabel;
 class QCheckBox;
+class QComboBox;
 class QStandardItemModel;
 struct CustomerProfileInfo;
 struct BookDetailsInfo;
@@ -74,6 +82,7 @@ private slots:
     void on_editProfileButton_clicked();
     void on_saveProfileButton_clicked();
     void updateSearchSuggestions(const QString &text);
+    void requestSearchSuggestions();
     void showBookDetails(int bookId);
     void on_addToCartButtonClicked(int bookId);
     void on_cartButton_clicked();
@@ -100,14 +109,21 @@ private:
     void displayComments(const QList<CommentDisplayInfo> &comments);
     void refreshBookComments();
     void displayBooks(const QList<BookDisplayInfo> &books, QGridLayout *targetLayout, QWidget *parentWidgetContext);
+    int calculateGridColumns(QGridLayout *targetLayout, QWidget *parentWidgetContext, int cardMinWidth) const;
     void displayAuthors(const QList<AuthorDisplayInfo> &authors);
+    void relayoutBooksGrid(QGridLayout *targetLayout, QWidget *parentWidgetContext);
+    void relayoutAuthorsGrid();
     void displayBooksInHorizontalLayout(const QList<BookDisplayInfo> &books, QHBoxLayout* layout);
     QWidget* createBookCardWidget(const BookDisplayInfo &bookInfo);
     QWidget* createAuthorCardWidget(const AuthorDisplayInfo &authorInfo);
     QWidget* createCommentWidget(const CommentDisplayInfo &commentInfo);
+    void updateBookCardWidget(QWidget *card, const BookDisplayInfo &bookInfo);
+    void updateAuthorCardWidget(QWidget *card, const AuthorDisplayInfo &authorInfo);
+    void updateCommentWidget(QWidget *commentWidget, const CommentDisplayInfo &commentInfo);
     void populateProfilePanel(const CustomerProfileInfo &profileInfo);
 
     QWidget* createOrderWidget(const OrderDisplayInfo &orderInfo);
+    void updateOrderWidget(QWidget *orderCard, const OrderDisplayInfo &orderInfo);
     void displayOrders(const QList<OrderDisplayInfo> &orders);
     void loadAndDisplayOrders();
 
@@ -115,6 +131,11 @@ private:
 
     void setProfileEditingEnabled(bool enabled);
     void populateBookDetailsPage(const BookDetailsInfo &details);
+    void setupBookSimilarityRebuild();
+    void refreshCatalogSnapshot();
+    void applyCatalogPatches();
+    void setupChangeNotifications();
+    void rebuildBookSimilarity();
     void populateAuthorDetailsPage(const AuthorDetailsInfo &details);
     void populateOrderDetailsPanel(const OrderDisplayInfo &orderInfo);
 
@@ -122,16 +143,21 @@ private:
     void updateCartTotal();
     void updateCartIcon();
     QWidget* createCartItemWidget(const CartItem &item, int bookId);
+    void updateCartItemWidget(QWidget *itemWidget, const CartItem &item);
 
     void setupSidebarAnimation();
     void toggleSidebar(bool expand);
     void setupSearchCompleter();
+    void refreshSearchIndex();
+    void showSearchSuggestions(const QString &text, const QList<SearchSuggestionInfo> &suggestions);
     void setupAutoBanner();
     void updateBannerImages();
     void setupFilterPanel();
     void loadAndDisplayFilteredBooks();
     void loadAndDisplayAuthors();
     void loadCartFromDatabase();
+    void queueCartChange(int bookId, int quantity);
+    bool flushCartChanges();
 
     Ui::MainWindow *ui;
     DatabaseManager *m_dbManager;
@@ -146,9 +172,41 @@ private:
     QCompleter *m_searchCompleter = nullptr;
     QStandardItemModel *m_searchSuggestionModel = nullptr;
     SearchSuggestionDelegate *m_searchDelegate = nullptr;
+    SearchPrefixIndex m_searchIndex; // Підказки відповідаються локально, без запиту до БД
+    QTimer *m_searchIndexRefreshTimer = nullptr;
+    bool m_searchIndexRefreshInFlight = false;
+    QTimer *m_searchDebounceTimer = nullptr;
+    QString m_pendingSearchText;
+    bool m_fuzzySearchAvailable = false; // pg_trgm встановлено — доступний пошук підрядка та нечіткий збіг
+    // Номер останнього запиту підказок: застарілі відповіді відкидаються, а ще не
+    // виконані фонові запити пропускаються без звернення до БД
+    QSharedPointer<QAtomicInt> m_searchGeneration = QSharedPointer<QAtomicInt>::create(0);
+
+    bool m_catalogSnapshotRefreshInFlight = false;
+    bool m_catalogSnapshotRefreshPending = false;
+    // Сповіщення про зміни в БД (DatabaseManager::bookChanged та ін.) групуються таймерами,
+    // щоб пакетна зміна багатьох рядків призводила до одного перезавантаження
+    QTimer *m_catalogChangeTimer = nullptr;
+    // UPDATE рядків book (залишок, ціна, рейтинг) застосовуються до копії знімка на місці,
+    // без повторного завантаження каталогу; bookId -> останній стан рядка
+    QHash<int, BookChangeInfo> m_pendingCatalogPatches;
+    QTimer *m_catalogPatchTimer = nullptr;
+    QTimer *m_cartChangeTimer = nullptr;
+    // Періодичний фоновий перерахунок рекомендацій "Схожі книги" (book_similarity)
+    QTimer *m_similarityRebuildTimer = nullptr;
+    bool m_similarityRebuildInFlight = false;
 
     QMap<int, CartItem> m_cartItems;
     QMap<int, QLabel*> m_cartSubtotalLabels;
+    // Журнал змін кошика (write-behind): bookId -> остання кількість, 0 — видалити.
+    // Записується в БД одним запитом за таймером, при переході між сторінками та перед оформленням
+    QMap<int, int> m_pendingCartChanges;
+    QTimer *m_cartFlushTimer = nullptr;
+    // Зміни кошика з початку останнього фонового loadCartFromDatabase: журнал може бути
+    // записаний ще до завершення завантаження, тож його самого для накладання не досить
+    QMap<int, int> m_cartChangesSinceLoad;
+    int m_cartLoadGeneration = 0;
+    bool m_checkoutInFlight = false; // Замовлення оформлюється у фоновому потоці
 
     int m_currentBookDetailsId = -1;
     int m_currentAuthorDetailsId = -1;
@@ -169,8 +227,11 @@ private:
     QLabel *m_minPriceValueLabel = nullptr;
     QLabel *m_maxPriceValueLabel = nullptr;
     QCheckBox *m_inStockFilterCheckBox = nullptr;
+    QComboBox *m_sortOrderComboBox = nullptr;
 
     QTimer *m_filterApplyTimer = nullptr;
+    BookGridModel *m_bookGridModel = nullptr;
+    BookCardDelegate *m_bookCardDelegate = nullptr;
 
     QFrame *m_orderDetailsPanel = nullptr;
     QPropertyAnimation *m_orderDetailsAnimation = nullptr;
@@ -187,6 +248,10 @@ private:
 
     QLabel *m_cartBadgeLabel = nullptr;
 
+    // Картки списків (книги, автори, замовлення, відгуки, кошик) для кожного layout:
+    // повторне відображення перевикористовує віджети за ID замість clearLayout
+    QHash<QLayout*, KeyedWidgetList> m_keyedWidgetLists;
+
 
 protected:
     bool eventFilter(QObject *watched, QEvent *event) override;
@@ -11,6 +11,35 @@
 #include <QGridLayout>
 #include <QSpacerItem>
 #include <QScrollArea> // Додано для доступу до QScrollArea
+#include "asyncimageloader.h"
+#include "keyedwidgetlist.h"
+
+namespace {
+const int kAuthorCardMinWidth = 180; // Мінімальна ширина картки автора, за нею рахуються стовпці сітки
+
+void loadAuthorCardPhoto(QLabel *photoLabel, const QString &imagePath)
+{
+    photoLabel->setProperty("imagePath", imagePath);
+    // Спершу заглушка, фото підставляється після фонового декодування
+    photoLabel->setPixmap(QPixmap());
+    photoLabel->setText(QObject::tr("👤"));
+    photoLabel->setStyleSheet("QLabel { background-color: #e0e0e0; color: #555; border-radius: 75px; font-size: 80pt; qproperty-alignment: AlignCenter; }");
+    AsyncImageLoader::instance()->loadPixmap(photoLabel, imagePath, QSize(150, 150), Qt::KeepAspectRatioByExpanding,
+                                             [photoLabel](const QPixmap &photoPixmap) {
+        QPixmap scaledPixmap = photoPixmap;
+        QBitmap mask(scaledPixmap.size());
+        mask.fill(Qt::color0);
+        QPainter painter(&mask);
+        painter.setBrush(Qt::color1);
+        painter.drawEllipse(0, 0, scaledPixmap.width(), scaledPixmap.height());
+        painter.end();
+        scaledPixmap.setMask(mask);
+        photoLabel->setText("");
+        photoLabel->setPixmap(scaledPixmap);
+        photoLabel->setStyleSheet("QLabel { border-radius: 75px; }");
+    });
+}
+}
 
 QWidget* MainWindow::createAuthorCardWidget(const AuthorDisplayInfo &authorInfo)
 {
@@ -18,7 +47,7 @@ QWidget* MainWindow::createAuthorCardWidget(const AuthorDisplayInfo &authorInfo)
     cardFrame->setFrameShape(QFrame::StyledPanel);
     cardFrame->setFrameShadow(QFrame::Raised);
     cardFrame->setLineWidth(1);
-    cardFrame->setMinimumSize(180, 250); // Використовуємо цю мінімальну ширину для розрахунків
+    cardFrame->setMinimumSize(kAuthorCardMinWidth, 250); // Використовуємо цю мінімальну ширину для розрахунків
     cardFrame->setMaximumSize(220, 280);
     cardFrame->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
     cardFrame->setStyleSheet("QFrame { background-color: white; border-radius: 8px; }");
@@ -28,43 +57,32 @@ QWidget* MainWindow::createAuthorCardWidget(const AuthorDisplayInfo &authorInfo)
     cardLayout->setContentsMargins(10, 10, 10, 10);
 
     QLabel *photoLabel = new QLabel();
+    photoLabel->setObjectName("authorCardPhotoLabel");
     photoLabel->setAlignment(Qt::AlignCenter);
     photoLabel->setMinimumSize(150, 150);
     photoLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-    QPixmap photoPixmap(authorInfo.imagePath);
-    if (photoPixmap.isNull() || authorInfo.imagePath.isEmpty()) {
-        photoLabel->setText(tr("👤"));
-        photoLabel->setStyleSheet("QLabel { background-color: #e0e0e0; color: #555; border-radius: 75px; font-size: 80pt; qproperty-alignment: AlignCenter; }");
-    } else {
-        QPixmap scaledPixmap = photoPixmap.scaled(150, 150, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-        QBitmap mask(scaledPixmap.size());
-        mask.fill(Qt::color0);
-        QPainter painter(&mask);
-        painter.setBrush(Qt::color1);
-        painter.drawEllipse(0, 0, scaledPixmap.width(), scaledPixmap.height());
-        painter.end();
-        scaledPixmap.setMask(mask);
-        photoLabel->setPixmap(scaledPixmap);
-        photoLabel->setStyleSheet("QLabel { border-radius: 75px; }");
-    }
+    loadAuthorCardPhoto(photoLabel, authorInfo.imagePath);
     cardLayout->addWidget(photoLabel, 0, Qt::AlignHCenter);
 
     QLabel *nameLabel = new QLabel(authorInfo.firstName + " " + authorInfo.lastName);
+    nameLabel->setObjectName("authorCardNameLabel");
     nameLabel->setWordWrap(true);
     nameLabel->setAlignment(Qt::AlignCenter);
     nameLabel->setStyleSheet("QLabel { font-weight: bold; font-size: 11pt; margin-top: 5px; }");
     cardLayout->addWidget(nameLabel);
 
-    if (!authorInfo.nationality.isEmpty()) {
-        QLabel *nationalityLabel = new QLabel(authorInfo.nationality);
-        nationalityLabel->setAlignment(Qt::AlignCenter);
-        nationalityLabel->setStyleSheet("QLabel { color: #777; font-size: 9pt; }");
-        cardLayout->addWidget(nationalityLabel);
-    }
+    // Мітка є завжди (прихована без даних), щоб updateAuthorCardWidget міг її показати
+    QLabel *nationalityLabel = new QLabel(authorInfo.nationality);
+    nationalityLabel->setObjectName("authorCardNationalityLabel");
+    nationalityLabel->setAlignment(Qt::AlignCenter);
+    nationalityLabel->setStyleSheet("QLabel { color: #777; font-size: 9pt; }");
+    nationalityLabel->setVisible(!authorInfo.nationality.isEmpty());
+    cardLayout->addWidget(nationalityLabel);
 
     cardLayout->addStretch(1);
 
     QPushButton *viewBooksButton = new QPushButton(tr("Переглянути книги"));
+    viewBooksButton->setObjectName("authorCardViewBooksButton");
     viewBooksButton->setStyleSheet("QPushButton { background-color: #0078d4; color: white; border: none; border-radius: 8px; padding: 6px; font-size: 9pt; } QPushButton:hover { background-color: #106ebe; }");
     viewBooksButton->setToolTip(tr("Переглянути книги автора %1 %2").arg(authorInfo.firstName, authorInfo.lastName));
 
@@ -79,6 +97,23 @@ QWidget* MainWindow::createAuthorCardWidget(const AuthorDisplayInfo &authorInfo)
     return cardFrame;
 }
 
+void MainWindow::updateAuthorCardWidget(QWidget *card, const AuthorDisplayInfo &authorInfo)
+{
+    QLabel *photoLabel = card->findChild<QLabel*>("authorCardPhotoLabel");
+    if (photoLabel && photoLabel->property("imagePath").toString() != authorInfo.imagePath) {
+        loadAuthorCardPhoto(photoLabel, authorInfo.imagePath);
+    }
+    KeyedWidgetList::setLabelText(card->findChild<QLabel*>("authorCardNameLabel"), authorInfo.firstName + " " + authorInfo.lastName);
+    if (QLabel *nationalityLabel = card->findChild<QLabel*>("authorCardNationalityLabel")) {
+        KeyedWidgetList::setLabelText(nationalityLabel, authorInfo.nationality);
+        nationalityLabel->setVisible(!authorInfo.nationality.isEmpty());
+    }
+    if (QPushButton *viewBooksButton = card->findChild<QPushButton*>("authorCardViewBooksButton")) {
+        const QString toolTip = tr("Переглянути книги автора %1 %2").arg(authorInfo.firstName, authorInfo.lastName);
+        if (viewBooksButton->toolTip() != toolTip) viewBooksButton->setToolTip(toolTip);
+    }
+}
+
 void MainWindow::displayAuthors(const QList<AuthorDisplayInfo> &authors)
 {
     if (!ui->authorsContainerLayout || !ui->authorsContainerWidget) {
@@ -95,31 +130,21 @@ void MainWindow::displayAuthors(const QList<AuthorDisplayInfo> &authors)
         return;
     }
 
-    clearLayout(ui->authorsContainerLayout);
+    const int numColumns = calculateGridColumns(ui->authorsContainerLayout, ui->authorsContainerWidget, kAuthorCardMinWidth);
 
-    int availableWidth = 0;
-    QScrollArea* scrollArea = ui->authorsContainerWidget->parentWidget() ? qobject_cast<QScrollArea*>(ui->authorsContainerWidget->parentWidget()) : nullptr;
-    if (scrollArea && scrollArea->viewport()) {
-        availableWidth = scrollArea->viewport()->width();
-        qDebug() << "displayAuthors: Using viewport width:" << availableWidth;
-    } else {
-        availableWidth = ui->authorsContainerWidget->width();
-        qWarning() << "displayAuthors: Could not get scroll area viewport width, using authorsContainerWidget width:" << availableWidth;
-    }
-    availableWidth -= (ui->authorsContainerLayout->contentsMargins().left() + ui->authorsContainerLayout->contentsMargins().right());
-
-    const int cardMinWidth = 180; // Використовуємо мінімальну ширину картки автора
-    int hSpacing = ui->authorsContainerLayout->horizontalSpacing();
-    if (hSpacing < 0) hSpacing = 10; // Default spacing if not set
-
-    int effectiveCardWidth = cardMinWidth + hSpacing;
-    int numColumns = 1;
-    if (effectiveCardWidth > 0 && availableWidth >= cardMinWidth) {
-        numColumns = (availableWidth + hSpacing) / effectiveCardWidth;
+    // Remove old stretch settings
+    for (int c = 0; c < ui->authorsContainerLayout->columnCount(); ++c) {
+        ui->authorsContainerLayout->setColumnStretch(c, 0);
     }
-    numColumns = qMax(1, numColumns);
-    qDebug() << "displayAuthors: Calculated columns:" << numColumns << "(spacing:" << hSpacing << ", cardMinWidth:" << cardMinWidth << ", availableWidth:" << availableWidth << ")";
 
+    // Картки з тим самим authorId перевикористовуються, змінюються лише відмінності
+    KeyedWidgetList &cards = m_keyedWidgetLists[ui->authorsContainerLayout];
+    cards.reconcile(authors,
+        [](const AuthorDisplayInfo &authorInfo) { return authorInfo.authorId; },
+        [this](const AuthorDisplayInfo &authorInfo) { return createAuthorCardWidget(authorInfo); },
+        [this](QWidget *card, const AuthorDisplayInfo &authorInfo) { updateAuthorCardWidget(card, authorInfo); });
+    qDebug() << "displayAuthors: created" << cards.lastCreated() << "reused" << cards.lastReused() << "removed" << cards.lastRemoved();
+    cards.layoutGrid(ui->authorsContainerLayout, numColumns);
 
     if (authors.isEmpty()) {
         QLabel *noAuthorsLabel = new QLabel(tr("Не вдалося завантажити авторів або їх немає в базі даних."), ui->authorsContainerWidget);
@@ -130,35 +155,18 @@ void MainWindow::displayAuthors(const QList<AuthorDisplayInfo> &authors)
         return;
     }
 
-    int row = 0;
-    int col = 0;
-
-    for (const AuthorDisplayInfo &authorInfo : authors) {
-        QWidget *authorCard = createAuthorCardWidget(authorInfo);
-        if (authorCard) {
-            ui->authorsContainerLayout->addWidget(authorCard, row, col);
-            col++;
-            if (col >= numColumns) {
-                col = 0;
-                row++;
-            }
-        }
-    }
-
-    // Remove old stretch settings
-    for (int c = 0; c < ui->authorsContainerLayout->columnCount(); ++c) {
-        ui->authorsContainerLayout->setColumnStretch(c, 0);
-    }
+    ui->authorsContainerWidget->updateGeometry();
+}
 
-    // Add horizontal spacer to push items to the left
-    if (col > 0) { // If the last row is not full
-         ui->authorsContainerLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Minimum), row, col, 1, numColumns - col);
+// Зміна ширини вікна: наявні картки авторів переставляються без звернення до БД
+void MainWindow::relayoutAuthorsGrid()
+{
+    if (!ui->authorsContainerLayout || !ui->authorsContainerWidget) return;
+    const int numColumns = calculateGridColumns(ui->authorsContainerLayout, ui->authorsContainerWidget, kAuthorCardMinWidth);
+    if (m_keyedWidgetLists[ui->authorsContainerLayout].relayoutGrid(ui->authorsContainerLayout, numColumns)) {
+        qDebug() << "relayoutAuthorsGrid: columns changed to" << numColumns;
+        ui->authorsContainerWidget->updateGeometry();
     }
-    // Add vertical spacer to push items to the top
-    ui->authorsContainerLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Minimum, QSizePolicy::Expanding), row + (col == 0 ? 0 : 1), 0, 1, numColumns);
-
-
-    ui->authorsContainerWidget->updateGeometry();
 }
 
 void MainWindow::loadAndDisplayAuthors()
@@ -12,16 +12,39 @@
 #include <QSpacerItem>
 #include <QHBoxLayout>
 #include "starratingwidget.h"
+#include "coverimagecache.h"
+#include "asyncimageloader.h"
+#include "bookgridmodel.h"
+#include "catalogsnapshot.h"
+#include "keyedwidgetlist.h"
 #include <QLineEdit>
 #include <QScrollArea> // Додано для доступу до QScrollArea
 
+namespace {
+const int kBookCardMinWidth = 200; // Мінімальна ширина картки книги (див. createBookCardWidget)
+
+void loadBookCardCover(QLabel *coverLabel, const QString &coverImagePath)
+{
+    coverLabel->setProperty("imagePath", coverImagePath);
+    // Спершу заглушка, обкладинка підставляється після фонового декодування
+    coverLabel->setPixmap(QPixmap());
+    coverLabel->setText(QObject::tr("Немає\nобкладинки"));
+    coverLabel->setStyleSheet("QLabel { background-color: #e0e0e0; color: #555; border-radius: 4px; }");
+    AsyncImageLoader::instance()->loadPixmap(coverLabel, coverImagePath, QSize(180, 240), Qt::KeepAspectRatio,
+                                             [coverLabel](const QPixmap &coverPixmap) {
+        coverLabel->setPixmap(coverPixmap);
+        coverLabel->setStyleSheet("");
+    });
+}
+}
+
 QWidget* MainWindow::createBookCardWidget(const BookDisplayInfo &bookInfo)
 {
     QFrame *cardFrame = new QFrame();
     cardFrame->setFrameShape(QFrame::StyledPanel);
     cardFrame->setFrameShadow(QFrame::Raised);
     cardFrame->setLineWidth(1);
-    cardFrame->setMinimumSize(200, 300);
+    cardFrame->setMinimumSize(kBookCardMinWidth, 300);
     cardFrame->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
     cardFrame->setStyleSheet("QFrame { background-color: white; border-radius: 8px; }");
 
@@ -30,36 +53,29 @@ QWidget* MainWindow::createBookCardWidget(const BookDisplayInfo &bookInfo)
     cardLayout->setContentsMargins(10, 10, 10, 10);
 
     QLabel *coverLabel = new QLabel();
+    coverLabel->setObjectName("bookCardCoverLabel");
     coverLabel->setAlignment(Qt::AlignCenter);
     coverLabel->setMinimumHeight(150);
     coverLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-    QPixmap coverPixmap;
-    if (!bookInfo.coverImagePath.isEmpty()) {
-        coverPixmap.load(bookInfo.coverImagePath);
-    }
-
-    if (coverPixmap.isNull()) {
-        coverLabel->setText(tr("Немає\nобкладинки"));
-        coverLabel->setStyleSheet("QLabel { background-color: #e0e0e0; color: #555; border-radius: 4px; }");
-    } else {
-        coverLabel->setPixmap(coverPixmap.scaled(180, 240, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        coverLabel->setStyleSheet("");
-    }
+    loadBookCardCover(coverLabel, bookInfo.coverImagePath);
     cardLayout->addWidget(coverLabel);
 
     QLabel *titleLabel = new QLabel(bookInfo.title);
+    titleLabel->setObjectName("bookCardTitleLabel");
     titleLabel->setWordWrap(true);
     titleLabel->setAlignment(Qt::AlignCenter);
     titleLabel->setStyleSheet("QLabel { font-weight: bold; font-size: 11pt; }");
     cardLayout->addWidget(titleLabel);
 
     QLabel *authorLabel = new QLabel(bookInfo.authors.isEmpty() ? tr("Невідомий автор") : bookInfo.authors);
+    authorLabel->setObjectName("bookCardAuthorLabel");
     authorLabel->setWordWrap(true);
     authorLabel->setAlignment(Qt::AlignCenter);
     authorLabel->setStyleSheet("QLabel { color: #555; font-size: 9pt; }");
     cardLayout->addWidget(authorLabel);
 
     QLabel *priceLabel = new QLabel(QString::number(bookInfo.price, 'f', 2) + tr(" грн"));
+    priceLabel->setObjectName("bookCardPriceLabel");
     priceLabel->setAlignment(Qt::AlignCenter);
     priceLabel->setStyleSheet("QLabel { font-weight: bold; color: #007bff; font-size: 10pt; margin-top: 5px; }");
     cardLayout->addWidget(priceLabel);
@@ -67,6 +83,7 @@ QWidget* MainWindow::createBookCardWidget(const BookDisplayInfo &bookInfo)
     cardLayout->addStretch(1);
 
     QPushButton *addToCartButton = new QPushButton(tr("🛒 Додати"));
+    addToCartButton->setObjectName("bookCardAddToCartButton");
     addToCartButton->setStyleSheet("QPushButton { background-color: #28a745; color: white; border: none; border-radius: 8px; padding: 8px; font-size: 9pt; } QPushButton:hover { background-color: #218838; }");
     addToCartButton->setToolTip(tr("Додати '%1' до кошика").arg(bookInfo.title));
     addToCartButton->setProperty("bookId", bookInfo.bookId);
@@ -84,34 +101,38 @@ QWidget* MainWindow::createBookCardWidget(const BookDisplayInfo &bookInfo)
     return cardFrame;
 }
 
-
-void MainWindow::displayBooks(const QList<BookDisplayInfo> &books, QGridLayout *targetLayout, QWidget *parentWidgetContext)
+// Оновлює лише ті поля картки, що змінилися (книга з тим самим bookId)
+void MainWindow::updateBookCardWidget(QWidget *card, const BookDisplayInfo &bookInfo)
 {
-    if (!targetLayout) {
-        qWarning() << "displayBooks: targetLayout is null!";
-        return;
+    QLabel *coverLabel = card->findChild<QLabel*>("bookCardCoverLabel");
+    if (coverLabel && coverLabel->property("imagePath").toString() != bookInfo.coverImagePath) {
+        loadBookCardCover(coverLabel, bookInfo.coverImagePath);
     }
-    if (!parentWidgetContext) {
-        qWarning() << "displayBooks: parentWidgetContext is null!";
-        parentWidgetContext = targetLayout->parentWidget();
-        if (!parentWidgetContext) {
-            qWarning() << "displayBooks: Could not determine parent widget context!";
-            return;
-        }
+    KeyedWidgetList::setLabelText(card->findChild<QLabel*>("bookCardTitleLabel"), bookInfo.title);
+    KeyedWidgetList::setLabelText(card->findChild<QLabel*>("bookCardAuthorLabel"),
+                                  bookInfo.authors.isEmpty() ? tr("Невідомий автор") : bookInfo.authors);
+    KeyedWidgetList::setLabelText(card->findChild<QLabel*>("bookCardPriceLabel"),
+                                  QString::number(bookInfo.price, 'f', 2) + tr(" грн"));
+    if (QPushButton *addToCartButton = card->findChild<QPushButton*>("bookCardAddToCartButton")) {
+        const QString toolTip = tr("Додати '%1' до кошика").arg(bookInfo.title);
+        if (addToCartButton->toolTip() != toolTip) addToCartButton->setToolTip(toolTip);
     }
+}
 
+
+int MainWindow::calculateGridColumns(QGridLayout *targetLayout, QWidget *parentWidgetContext, int cardMinWidth) const
+{
     int availableWidth = 0;
     QScrollArea* scrollArea = parentWidgetContext->parentWidget() ? qobject_cast<QScrollArea*>(parentWidgetContext->parentWidget()) : nullptr;
     if (scrollArea && scrollArea->viewport()) {
         availableWidth = scrollArea->viewport()->width();
-        qDebug() << "displayBooks: Using viewport width:" << availableWidth;
+        qDebug() << "calculateGridColumns: Using viewport width:" << availableWidth;
     } else {
         availableWidth = parentWidgetContext->width();
-        qWarning() << "displayBooks: Could not get scroll area viewport width, using parentWidgetContext width:" << availableWidth;
+        qWarning() << "calculateGridColumns: Could not get scroll area viewport width, using parentWidgetContext width:" << availableWidth;
     }
     availableWidth -= (targetLayout->contentsMargins().left() + targetLayout->contentsMargins().right());
 
-    const int cardMinWidth = 200;
     int hSpacing = targetLayout->horizontalSpacing();
     if (hSpacing < 0) hSpacing = 10; // Default spacing if not set
 
@@ -121,9 +142,36 @@ void MainWindow::displayBooks(const QList<BookDisplayInfo> &books, QGridLayout *
         numColumns = (availableWidth + hSpacing) / effectiveCardWidth;
     }
     numColumns = qMax(1, numColumns);
-    qDebug() << "displayBooks: Calculated columns:" << numColumns << "(spacing:" << hSpacing << ", cardMinWidth:" << cardMinWidth << ", availableWidth:" << availableWidth << ")";
+    qDebug() << "calculateGridColumns: Calculated columns:" << numColumns << "(spacing:" << hSpacing << ", cardMinWidth:" << cardMinWidth << ", availableWidth:" << availableWidth << ")";
+
+    return numColumns;
+}
+
+void MainWindow::displayBooks(const QList<BookDisplayInfo> &books, QGridLayout *targetLayout, QWidget *parentWidgetContext)
+{
+    if (!targetLayout) {
+        qWarning() << "displayBooks: targetLayout is null!";
+        return;
+    }
+    if (!parentWidgetContext) {
+        qWarning() << "displayBooks: parentWidgetContext is null!";
+        parentWidgetContext = targetLayout->parentWidget();
+        if (!parentWidgetContext) {
+            qWarning() << "displayBooks: Could not determine parent widget context!";
+            return;
+        }
+    }
+
+    const int numColumns = calculateGridColumns(targetLayout, parentWidgetContext, kBookCardMinWidth);
 
-    clearLayout(targetLayout);
+    // Картки з тим самим bookId перевикористовуються, створюються/видаляються лише відмінності
+    KeyedWidgetList &cards = m_keyedWidgetLists[targetLayout];
+    cards.reconcile(books,
+        [](const BookDisplayInfo &bookInfo) { return bookInfo.bookId; },
+        [this](const BookDisplayInfo &bookInfo) { return createBookCardWidget(bookInfo); },
+        [this](QWidget *card, const BookDisplayInfo &bookInfo) { updateBookCardWidget(card, bookInfo); });
+    qDebug() << "displayBooks: created" << cards.lastCreated() << "reused" << cards.lastReused() << "removed" << cards.lastRemoved();
+    cards.layoutGrid(targetLayout, numColumns);
 
     if (books.isEmpty()) {
         QLabel *noBooksLabel = new QLabel(tr("Не вдалося завантажити книги або їх немає в базі даних."), parentWidgetContext);
@@ -134,32 +182,21 @@ void MainWindow::displayBooks(const QList<BookDisplayInfo> &books, QGridLayout *
         return;
     }
 
-    int row = 0;
-    int col = 0;
-
-    for (const BookDisplayInfo &bookInfo : books) {
-        QWidget *bookCard = createBookCardWidget(bookInfo);
-        if (bookCard) {
-            targetLayout->addWidget(bookCard, row, col);
-            col++;
-            if (col >= numColumns) {
-                col = 0;
-                row++;
-            }
-        }
-    }
-
-    // Add horizontal spacer to push items to the left
-    if (col > 0) { // If the last row is not full
-         targetLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Minimum), row, col, 1, numColumns - col);
-    }
-    // Add vertical spacer to push items to the top
-    targetLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Minimum, QSizePolicy::Expanding), row + (col == 0 ? 0 : 1), 0, 1, numColumns);
-
-
     parentWidgetContext->updateGeometry();
 }
 
+// Зміна ширини вікна: картки книг у сітці лише переставляються, якщо змінилася кількість стовпців
+void MainWindow::relayoutBooksGrid(QGridLayout *targetLayout, QWidget *parentWidgetContext)
+{
+    if (!targetLayout || !parentWidgetContext) return;
+    auto cards = m_keyedWidgetLists.find(targetLayout);
+    if (cards == m_keyedWidgetLists.end()) return; // Сітку ще не відображали
+    const int numColumns = calculateGridColumns(targetLayout, parentWidgetContext, kBookCardMinWidth);
+    if (cards->relayoutGrid(targetLayout, numColumns)) {
+        qDebug() << "relayoutBooksGrid: columns changed to" << numColumns;
+        parentWidgetContext->updateGeometry();
+    }
+}
 
 void MainWindow::displayBooksInHorizontalLayout(const QList<BookDisplayInfo> &books, QHBoxLayout* layout)
 {
@@ -238,12 +275,12 @@ void MainWindow::populateBookDetailsPage(const BookDetailsInfo &details)
         return;
     }
 
-    QPixmap coverPixmap(details.coverImagePath);
-    if (coverPixmap.isNull() || details.coverImagePath.isEmpty()) {
+    const QPixmap coverPixmap = CoverImageCache::instance().pixmap(details.coverImagePath, ui->bookDetailCoverLabel->size());
+    if (coverPixmap.isNull()) {
         ui->bookDetailCoverLabel->setText(tr("Немає\nобкладинки"));
         ui->bookDetailCoverLabel->setStyleSheet("QLabel { background-color: #e0e0e0; color: #555; border: 1px solid #ccc; border-radius: 4px; }");
     } else {
-        ui->bookDetailCoverLabel->setPixmap(coverPixmap.scaled(ui->bookDetailCoverLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+        ui->bookDetailCoverLabel->setPixmap(coverPixmap);
         ui->bookDetailCoverLabel->setStyleSheet("QLabel { background-color: transparent; border: 1px solid #ccc; border-radius: 4px; }");
     }
 
@@ -323,7 +360,7 @@ void MainWindow::populateBookDetailsPage(const BookDetailsInfo &details)
     }
 
     if (ui->similarBooksWidget && ui->similarBooksLayout) {
-        if (!details.genre.isEmpty() && m_dbManager) {
+        if (m_dbManager) {
             QList<BookDisplayInfo> similarBooks = m_dbManager->getSimilarBooks(details.bookId, details.genre, 5);
 
             if (!similarBooks.isEmpty()) {
@@ -334,7 +371,7 @@ void MainWindow::populateBookDetailsPage(const BookDetailsInfo &details)
             } else {
                 clearLayout(ui->similarBooksLayout);
                 ui->similarBooksWidget->setVisible(false);
-                qInfo() << "No similar books found for genre:" << details.genre;
+                qInfo() << "No similar books found for book" << details.bookId << "genre:" << details.genre;
             }
         } else {
             clearLayout(ui->similarBooksLayout);
@@ -348,3 +385,92 @@ void MainWindow::populateBookDetailsPage(const BookDetailsInfo &details)
 
     qInfo() << "Book details page populated for:" << details.title;
 }
+
+// Рекомендації перераховуються у фоновому потоці: вперше — невдовзі після запуску
+// (щоб не конкурувати із завантаженням каталогу), далі — раз на годину
+void MainWindow::setupBookSimilarityRebuild()
+{
+    m_similarityRebuildTimer = new QTimer(this);
+    m_similarityRebuildTimer->setInterval(60 * 60 * 1000);
+    connect(m_similarityRebuildTimer, &QTimer::timeout, this, &MainWindow::rebuildBookSimilarity);
+    m_similarityRebuildTimer->start();
+    QTimer::singleShot(30 * 1000, this, &MainWindow::rebuildBookSimilarity);
+}
+
+void MainWindow::rebuildBookSimilarity()
+{
+    if (!m_dbManager || m_similarityRebuildInFlight) {
+        return;
+    }
+    m_similarityRebuildInFlight = true;
+    m_dbManager->rebuildBookSimilarityAsync(10, this, [this](bool success) {
+        m_similarityRebuildInFlight = false;
+        if (!success) {
+            qWarning() << "Не вдалося перерахувати рекомендації book_similarity.";
+        }
+    });
+}
+
+// Завантажує колонковий знімок каталогу у фоні; після цього фільтри на сторінці книг
+// обчислюються локально. Викликається при запуску та після змін, що зачіпають каталог.
+void MainWindow::refreshCatalogSnapshot()
+{
+    if (!m_dbManager || !m_bookGridModel) {
+        return;
+    }
+    if (m_catalogSnapshotRefreshInFlight) {
+        m_catalogSnapshotRefreshPending = true; // Зміна прийшла під час завантаження — перезавантажимо ще раз
+        return;
+    }
+    m_catalogSnapshotRefreshInFlight = true;
+    m_catalogSnapshotRefreshPending = false;
+    m_dbManager->getCatalogSnapshotAsync(this, [this](const CatalogSnapshot &snapshot) {
+        m_catalogSnapshotRefreshInFlight = false;
+        if (m_catalogSnapshotRefreshPending) {
+            refreshCatalogSnapshot();
+            return;
+        }
+        if (snapshot.isEmpty()) {
+            qWarning() << "Catalog snapshot is empty, book filters keep using database queries.";
+            return;
+        }
+        m_bookGridModel->setCatalogSnapshot(QSharedPointer<const CatalogSnapshot>::create(snapshot));
+        qInfo() << "Book filters switched to in-memory catalog snapshot:" << snapshot.size() << "books";
+        // Оновлення, що надійшли під час завантаження, могли не потрапити до знімка; повторне
+        // застосування вже врахованих нічого не змінює
+        if (!m_pendingCatalogPatches.isEmpty()) {
+            applyCatalogPatches();
+        }
+    });
+}
+
+// Точкове оновлення знімка каталогу за сповіщеннями UPDATE book: модель тримає спільний
+// незмінний знімок, тож зміни вносяться в копію (колонки QVector копіюються лише при записі)
+void MainWindow::applyCatalogPatches()
+{
+    if (m_pendingCatalogPatches.isEmpty() || !m_bookGridModel) {
+        return;
+    }
+    if (m_catalogSnapshotRefreshInFlight) {
+        return; // Будуть застосовані до нового знімка після завантаження
+    }
+    const QSharedPointer<const CatalogSnapshot> current = m_bookGridModel->catalogSnapshot();
+    if (!current) {
+        m_pendingCatalogPatches.clear(); // Посторінкові запити й так читають актуальні дані
+        return;
+    }
+
+    QSharedPointer<CatalogSnapshot> patched = QSharedPointer<CatalogSnapshot>::create(*current);
+    for (const BookChangeInfo &change : std::as_const(m_pendingCatalogPatches)) {
+        if (!patched->updateBook(change)) {
+            // Нова книга або змінена назва (позиція в сортуванні) — лише повне перезавантаження
+            qInfo() << "Catalog snapshot patch for book" << change.book.bookId << "needs a full reload.";
+            m_pendingCatalogPatches.clear();
+            refreshCatalogSnapshot();
+            return;
+        }
+    }
+    qDebug() << "Catalog snapshot patched in place:" << m_pendingCatalogPatches.size() << "books";
+    m_pendingCatalogPatches.clear();
+    m_bookGridModel->updateCatalogSnapshot(patched);
+}
@@ -15,7 +15,28 @@
 #include <QLineEdit>
 #include <QPainter>
 #include <QIcon>
+#include <QSignalBlocker>
 #include "checkoutdialog.h"
+#include "asyncimageloader.h"
+#include "keyedwidgetlist.h"
+
+namespace {
+void loadCartItemCover(QLabel *coverLabel, const QString &coverImagePath)
+{
+    QSize labelSize = coverLabel->minimumSize();
+    if (!labelSize.isValid() || labelSize.width() <= 0 || labelSize.height() <= 0) {
+         labelSize = QSize(60, 85);
+    }
+    coverLabel->setProperty("imagePath", coverImagePath);
+    coverLabel->setPixmap(QPixmap());
+    coverLabel->setText(QObject::tr("Фото"));
+    AsyncImageLoader::instance()->loadPixmap(coverLabel, coverImagePath, labelSize, Qt::KeepAspectRatio,
+                                             [coverLabel](const QPixmap &coverPixmap) {
+        coverLabel->setPixmap(coverPixmap);
+        coverLabel->setText("");
+    });
+}
+}
 
 QWidget* MainWindow::createCartItemWidget(const CartItem &item, int bookId)
 {
@@ -31,18 +52,7 @@ QWidget* MainWindow::createCartItemWidget(const CartItem &item, int bookId)
     QLabel *coverLabel = new QLabel();
     coverLabel->setObjectName("cartItemCoverLabel");
     coverLabel->setAlignment(Qt::AlignCenter);
-    QPixmap coverPixmap(item.book.coverImagePath);
-    if (coverPixmap.isNull() || item.book.coverImagePath.isEmpty()) {
-        coverLabel->setText(tr("Фото"));
-    } else {
-        QSize labelSize = coverLabel->minimumSize();
-        if (!labelSize.isValid() || labelSize.width() <= 0 || labelSize.height() <= 0) {
-             labelSize = QSize(60, 85);
-             qWarning() << "Cart item cover label size not set, using default:" << labelSize;
-        }
-        coverLabel->setPixmap(coverPixmap.scaled(labelSize, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        coverLabel->setText("");
-    }
+    loadCartItemCover(coverLabel, item.book.coverImagePath);
     mainLayout->addWidget(coverLabel);
 
     QVBoxLayout *infoLayout = new QVBoxLayout();
@@ -81,7 +91,6 @@ QWidget* MainWindow::createCartItemWidget(const CartItem &item, int bookId)
     subtotalLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
     subtotalLabel->setMinimumWidth(80);
     mainLayout->addWidget(subtotalLabel, 1);
-    m_cartSubtotalLabels.insert(bookId, subtotalLabel);
 
     QPushButton *removeButton = new QPushButton();
     removeButton->setObjectName("cartRemoveButton");
@@ -93,10 +102,35 @@ QWidget* MainWindow::createCartItemWidget(const CartItem &item, int bookId)
     });
     mainLayout->addWidget(removeButton);
 
+    itemFrame->setProperty("bookId", bookId);
     itemFrame->setLayout(mainLayout);
     return itemFrame;
 }
 
+// Оновлює рядок кошика для тієї самої книги; сигнали спінбокса блокуються,
+// щоб синхронізація з m_cartItems не породжувала нових змін кошика
+void MainWindow::updateCartItemWidget(QWidget *itemWidget, const CartItem &item)
+{
+    QLabel *coverLabel = itemWidget->findChild<QLabel*>("cartItemCoverLabel");
+    if (coverLabel && coverLabel->property("imagePath").toString() != item.book.coverImagePath) {
+        loadCartItemCover(coverLabel, item.book.coverImagePath);
+    }
+    KeyedWidgetList::setLabelText(itemWidget->findChild<QLabel*>("cartItemTitleLabel"), item.book.title);
+    KeyedWidgetList::setLabelText(itemWidget->findChild<QLabel*>("cartItemAuthorLabel"), item.book.authors);
+    KeyedWidgetList::setLabelText(itemWidget->findChild<QLabel*>("cartItemPriceLabel"), QString::number(item.book.price, 'f', 2) + tr(" грн"));
+    KeyedWidgetList::setLabelText(itemWidget->findChild<QLabel*>("cartItemSubtotalLabel"),
+                                  QString::number(item.book.price * item.quantity, 'f', 2) + tr(" грн"));
+    if (QSpinBox *quantitySpinBox = itemWidget->findChild<QSpinBox*>("cartQuantitySpinBox")) {
+        const QSignalBlocker blocker(quantitySpinBox);
+        if (quantitySpinBox->maximum() != item.book.stockQuantity) quantitySpinBox->setMaximum(item.book.stockQuantity);
+        if (quantitySpinBox->value() != item.quantity) quantitySpinBox->setValue(item.quantity);
+    }
+    if (QPushButton *removeButton = itemWidget->findChild<QPushButton*>("cartRemoveButton")) {
+        const QString toolTip = tr("Видалити '%1' з кошика").arg(item.book.title);
+        if (removeButton->toolTip() != toolTip) removeButton->setToolTip(toolTip);
+    }
+}
+
 void MainWindow::on_addToCartButtonClicked(int bookId)
 {
     qInfo() << "Add to cart button clicked for book ID:" << bookId;
@@ -133,11 +167,7 @@ void MainWindow::on_addToCartButtonClicked(int bookId)
         qInfo() << "Added new book ID" << bookId << "to cart.";
     }
 
-    if (m_dbManager) {
-        m_dbManager->addOrUpdateCartItem(m_currentCustomerId, bookId, m_cartItems[bookId].quantity);
-    } else {
-        qWarning() << "on_addToCartButtonClicked: DatabaseManager is null, cannot save cart item to DB.";
-    }
+    queueCartChange(bookId, m_cartItems[bookId].quantity);
 
     updateCartIcon();
 
@@ -173,12 +203,17 @@ void MainWindow::populateCartPage()
         return;
     }
 
-    clearLayout(ui->cartItemsLayout);
-    m_cartSubtotalLabels.clear();
+    // Рядки кошика перевикористовуються за bookId; layout звільняється від заглушок та спейсера
+    KeyedWidgetList &cartRows = m_keyedWidgetLists[ui->cartItemsLayout];
+    const QList<QWidget*> rows = cartRows.reconcile(m_cartItems.keys(),
+        [](int bookId) { return bookId; },
+        [this](int bookId) { return createCartItemWidget(m_cartItems.value(bookId), bookId); },
+        [this](QWidget *itemWidget, int bookId) { updateCartItemWidget(itemWidget, m_cartItems.value(bookId)); });
+    KeyedWidgetList::placeInBoxLayout(ui->cartItemsLayout, rows);
 
-    QLabel* emptyCartLabel = ui->cartItemsContainerWidget->findChild<QLabel*>("emptyCartLabel");
-    if(emptyCartLabel) {
-        delete emptyCartLabel;
+    m_cartSubtotalLabels.clear();
+    for (QWidget *row : rows) {
+        m_cartSubtotalLabels.insert(row->property("bookId").toInt(), row->findChild<QLabel*>("cartItemSubtotalLabel"));
     }
 
     if (m_cartItems.isEmpty()) {
@@ -198,17 +233,8 @@ void MainWindow::populateCartPage()
 
     ui->cartTotalsWidget->setVisible(true);
 
-    for (auto it = m_cartItems.constBegin(); it != m_cartItems.constEnd(); ++it) {
-        QWidget *itemWidget = createCartItemWidget(it.value(), it.key());
-        if (itemWidget) {
-            ui->cartItemsLayout->addWidget(itemWidget);
-        }
-    }
-
-    ui->cartItemsLayout->addSpacerItem(new QSpacerItem(20, 1, QSizePolicy::Minimum, QSizePolicy::Expanding));
-
     updateCartTotal();
-    ui->placeOrderButton->setEnabled(true);
+    ui->placeOrderButton->setEnabled(!m_checkoutInFlight);
     qInfo() << "Cart page populated with" << m_cartItems.size() << "items.";
 
     ui->cartItemsContainerWidget->adjustSize();
@@ -296,11 +322,7 @@ void MainWindow::updateCartItemQuantity(int bookId, int quantity)
         updateCartTotal();
         updateCartIcon();
 
-        if (m_dbManager) {
-            m_dbManager->addOrUpdateCartItem(m_currentCustomerId, bookId, quantity);
-        } else {
-            qWarning() << "updateCartItemQuantity: DatabaseManager is null, cannot save cart item to DB.";
-        }
+        queueCartChange(bookId, quantity);
 
     } else {
         qWarning() << "Attempted to update quantity for non-existent book ID in cart:" << bookId;
@@ -309,15 +331,7 @@ void MainWindow::updateCartItemQuantity(int bookId, int quantity)
 
 void MainWindow::removeCartItem(int bookId)
 {
-     bool removedFromDb = false;
-     if (m_dbManager) {
-         removedFromDb = m_dbManager->removeCartItem(m_currentCustomerId, bookId);
-         if (!removedFromDb) {
-              qWarning() << "Failed to remove item (bookId:" << bookId << ") from DB cart for customerId:" << m_currentCustomerId;
-         }
-     } else {
-         qWarning() << "removeCartItem: DatabaseManager is null, cannot remove item from DB cart.";
-     }
+     queueCartChange(bookId, 0);
 
      if (m_cartItems.contains(bookId)) {
          QString bookTitle = m_cartItems[bookId].book.title;
@@ -334,10 +348,42 @@ void MainWindow::removeCartItem(int bookId)
      }
 }
 
+// Зміна лише запам'ятовується: кілька натискань "+" для однієї книги зливаються в один запис
+void MainWindow::queueCartChange(int bookId, int quantity)
+{
+    m_pendingCartChanges.insert(bookId, qMax(0, quantity));
+    m_cartChangesSinceLoad.insert(bookId, qMax(0, quantity)); // Для loadCartFromDatabase, що може бути в процесі
+    if (m_cartFlushTimer && !m_cartFlushTimer->isActive()) {
+        m_cartFlushTimer->start();
+    }
+}
+
+bool MainWindow::flushCartChanges()
+{
+    if (m_cartFlushTimer) {
+        m_cartFlushTimer->stop();
+    }
+    if (m_pendingCartChanges.isEmpty()) {
+        return true;
+    }
+    if (!m_dbManager || m_currentCustomerId <= 0) {
+        qWarning() << "flushCartChanges: DatabaseManager is null or customer ID is invalid, cart changes are not saved.";
+        return false;
+    }
+
+    if (!m_dbManager->applyCartChanges(m_currentCustomerId, m_pendingCartChanges)) {
+        qWarning() << "Failed to save" << m_pendingCartChanges.size() << "cart changes for customerId:" << m_currentCustomerId << "- will retry on next flush.";
+        return false;
+    }
+    qInfo() << "Saved" << m_pendingCartChanges.size() << "coalesced cart changes for customerId:" << m_currentCustomerId;
+    m_pendingCartChanges.clear();
+    return true;
+}
+
 void MainWindow::on_placeOrderButton_clicked()
 {
     qInfo() << "Place order button clicked. Opening checkout dialog...";
-    if (m_cartItems.isEmpty()) {
+    if (m_cartItems.isEmpty() || m_checkoutInFlight) {
         return;
     }
     if (!m_dbManager) {
@@ -388,40 +434,45 @@ void MainWindow::finalizeOrder(const QString &shippingAddress, const QString &pa
          itemsMap.insert(it.key(), it.value().quantity);
      }
 
-     int newOrderId = -1;
-     double orderTotal = m_dbManager->createOrder(m_currentCustomerId, itemsMap, shippingAddress, paymentMethod, newOrderId);
+     flushCartChanges();
+
+     // Замовлення оформлюється у фоновому потоці: очікування блокувань FOR UPDATE та пауз
+     // між повторами (createOrder) не повинно зупиняти цикл подій GUI
+     m_checkoutInFlight = true;
+     ui->placeOrderButton->setEnabled(false);
+     ui->statusBar->showMessage(tr("Оформлення замовлення..."));
 
-     if (orderTotal >= 0 && newOrderId > 0) {
-         qInfo() << "Order" << newOrderId << "placed successfully for total" << orderTotal;
+     // Бонусні бали та очищення кошика в БД фіксуються в тій самій транзакції, що й замовлення
+     m_dbManager->createOrderAsync(m_currentCustomerId, itemsMap, shippingAddress, paymentMethod, this,
+                                   [this, itemsMap](double orderTotal, int newOrderId, int loyaltyPoints) {
+         m_checkoutInFlight = false;
+         ui->statusBar->clearMessage();
 
-         int pointsToAdd = static_cast<int>(orderTotal / 10.0);
-         if (pointsToAdd > 0) {
-             qInfo() << "Adding" << pointsToAdd << "loyalty points for order total" << orderTotal;
-             if (m_dbManager->addLoyaltyPoints(m_currentCustomerId, pointsToAdd)) {
-                 qInfo() << "Loyalty points added successfully.";
-                 ui->statusBar->showMessage(tr("Вам нараховано %1 бонусних балів!").arg(pointsToAdd), 4000);
-             } else {
-                 qWarning() << "Failed to add loyalty points for customer ID:" << m_currentCustomerId;
+         if (orderTotal >= 0 && newOrderId > 0) {
+             qInfo() << "Order" << newOrderId << "placed successfully for total" << orderTotal << "loyalty points:" << loyaltyPoints;
+             if (loyaltyPoints > 0) {
+                 ui->statusBar->showMessage(tr("Вам нараховано %1 бонусних балів!").arg(loyaltyPoints), 4000);
+             }
+             // Оформлені позиції вже видалено з кошика в БД самим замовленням; зміни цих книг,
+             // зроблені поки замовлення виконувалось, відкидаються і в журналі, і в пам'яті.
+             // Книги, додані за цей час, лишаються в кошику.
+             for (auto it = itemsMap.constBegin(); it != itemsMap.constEnd(); ++it) {
+                 m_pendingCartChanges.remove(it.key());
+                 m_cartChangesSinceLoad.remove(it.key());
+                 m_cartItems.remove(it.key());
              }
-         } else {
-              qInfo() << "No loyalty points to add for order total" << orderTotal;
-         }
 
-         if (!m_dbManager->clearCart(m_currentCustomerId)) {
-             qWarning() << "Failed to clear DB cart for customerId:" << m_currentCustomerId << "after placing order.";
+             updateCartIcon();
+             populateCartPage();
+             refreshCatalogSnapshot(); // Залишки на складі змінилися
+             on_navOrdersButton_clicked();
+
          } else {
-             qInfo() << "DB cart cleared successfully for customerId:" << m_currentCustomerId;
+             // Причину вже залоговано у потоці воркера
+             QMessageBox::critical(this, tr("Помилка оформлення"), tr("Не вдалося оформити замовлення. Можливо, деяких товарів вже немає в наявності. Перевірте журнал помилок або спробуйте пізніше."));
+             qWarning() << "Failed to create order. Returned total:" << orderTotal;
+             loadCartFromDatabase();
+             populateCartPage();
          }
-
-         m_cartItems.clear();
-         updateCartIcon();
-         populateCartPage();
-         on_navOrdersButton_clicked();
-
-     } else {
-         QMessageBox::critical(this, tr("Помилка оформлення"), tr("Не вдалося оформити замовлення. Можливо, деяких товарів вже немає в наявності. Перевірте журнал помилок або спробуйте пізніше."));
-         qWarning() << "Failed to create order. DB Error:" << m_dbManager->lastError().text() << "Returned total:" << orderTotal;
-         loadCartFromDatabase();
-         populateCartPage();
-     }
+     });
 }
@@ -12,12 +12,18 @@
 #include <QPushButton> // Для on_sendCommentButton_clicked
 #include "starratingwidget.h" // Для createCommentWidget, on_sendCommentButton_clicked
 #include <QSpacerItem> // Для displayComments
+#include "keyedwidgetlist.h"
 
 // Допоміжна функція для відображення списку коментарів
 void MainWindow::displayComments(const QList<CommentDisplayInfo> &comments)
 {
-    // Очищаємо попередні коментарі та спейсер
-    clearLayout(ui->commentsListLayout); // Використовуємо правильний layout
+    // Відгуки з тим самим commentId перевикористовуються; layout звільняється від заглушок та спейсера
+    KeyedWidgetList &commentWidgets = m_keyedWidgetLists[ui->commentsListLayout];
+    const QList<QWidget*> widgets = commentWidgets.reconcile(comments,
+        [](const CommentDisplayInfo &commentInfo) { return commentInfo.commentId; },
+        [this](const CommentDisplayInfo &commentInfo) { return createCommentWidget(commentInfo); },
+        [this](QWidget *commentWidget, const CommentDisplayInfo &commentInfo) { updateCommentWidget(commentWidget, commentInfo); });
+    KeyedWidgetList::placeInBoxLayout(ui->commentsListLayout, widgets);
 
     if (comments.isEmpty()) {
         QLabel *noCommentsLabel = new QLabel(tr("Відгуків ще немає. Будьте першим!"));
@@ -26,15 +32,6 @@ void MainWindow::displayComments(const QList<CommentDisplayInfo> &comments)
         ui->commentsListLayout->addWidget(noCommentsLabel);
         // Додаємо спейсер, щоб мітка була по центру, якщо немає коментарів
         ui->commentsListLayout->addSpacerItem(new QSpacerItem(20, 40, QSizePolicy::Minimum, QSizePolicy::Expanding));
-    } else {
-        for (const CommentDisplayInfo &commentInfo : comments) {
-            QWidget *commentWidget = createCommentWidget(commentInfo);
-            if (commentWidget) {
-                ui->commentsListLayout->addWidget(commentWidget);
-            }
-        }
-        // Додаємо спейсер в кінці, щоб притиснути коментарі вгору
-        ui->commentsListLayout->addSpacerItem(new QSpacerItem(20, 1, QSizePolicy::Minimum, QSizePolicy::Expanding));
     }
 }
 
@@ -85,10 +82,12 @@ QWidget* MainWindow::createCommentWidget(const CommentDisplayInfo &commentInfo)
 
     // Ім'я автора (виділено)
     QLabel *authorLabel = new QLabel(commentInfo.authorName);
+    authorLabel->setObjectName("commentAuthorLabel");
     authorLabel->setStyleSheet("font-weight: 600; font-size: 11pt; color: #343a40;"); // Жирний, трохи більший
 
     // Дата (менш помітна, праворуч)
     QLabel *dateLabel = new QLabel(QLocale::system().toString(commentInfo.commentDate, QLocale::ShortFormat));
+    dateLabel->setObjectName("commentDateLabel");
     dateLabel->setStyleSheet("color: #868e96; font-size: 9pt;"); // Світліший сірий, менший шрифт
     dateLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
 
@@ -101,6 +100,7 @@ QWidget* MainWindow::createCommentWidget(const CommentDisplayInfo &commentInfo)
 
     // --- Рядок рейтингу (використовуємо StarRatingWidget) ---
     StarRatingWidget *ratingWidget = new StarRatingWidget();
+    ratingWidget->setObjectName("commentRatingWidget");
     ratingWidget->setMaxRating(5);
     ratingWidget->setRating(commentInfo.rating > 0 ? commentInfo.rating : 0); // Встановлюємо рейтинг (0 якщо не було)
     ratingWidget->setReadOnly(true); // Тільки для відображення
@@ -111,6 +111,7 @@ QWidget* MainWindow::createCommentWidget(const CommentDisplayInfo &commentInfo)
 
     // --- Текст коментаря ---
     QLabel *commentTextLabel = new QLabel(commentInfo.commentText);
+    commentTextLabel->setObjectName("commentTextLabel");
     commentTextLabel->setWordWrap(true); // Перенесення слів обов'язкове
     commentTextLabel->setStyleSheet("color: #495057; font-size: 10pt; line-height: 1.5;"); // Стандартний текст, міжрядковий інтервал
     mainLayout->addWidget(commentTextLabel);
@@ -120,6 +121,19 @@ QWidget* MainWindow::createCommentWidget(const CommentDisplayInfo &commentInfo)
     return commentFrame;
 }
 
+void MainWindow::updateCommentWidget(QWidget *commentWidget, const CommentDisplayInfo &commentInfo)
+{
+    KeyedWidgetList::setLabelText(commentWidget->findChild<QLabel*>("commentAuthorLabel"), commentInfo.authorName);
+    KeyedWidgetList::setLabelText(commentWidget->findChild<QLabel*>("commentDateLabel"),
+                                  QLocale::system().toString(commentInfo.commentDate, QLocale::ShortFormat));
+    KeyedWidgetList::setLabelText(commentWidget->findChild<QLabel*>("commentTextLabel"), commentInfo.commentText);
+    StarRatingWidget *ratingWidget = commentWidget->findChild<StarRatingWidget*>("commentRatingWidget");
+    const int rating = commentInfo.rating > 0 ? commentInfo.rating : 0;
+    if (ratingWidget && ratingWidget->rating() != rating) {
+        ratingWidget->setRating(rating);
+    }
+}
+
 // Слот для кнопки відправки коментаря
 void MainWindow::on_sendCommentButton_clicked()
 {
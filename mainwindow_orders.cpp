@@ -14,6 +14,8 @@
 #include <QDateEdit> // Для loadAndDisplayOrders
 #include <QStatusBar> // Для loadAndDisplayOrders
 #include <QPropertyAnimation> // Для анімації панелі деталей
+#include <QStyle>
+#include "keyedwidgetlist.h"
 
 // Слот для кнопки навігації "Замовлення"
 void MainWindow::on_navOrdersButton_clicked()
@@ -22,6 +24,40 @@ void MainWindow::on_navOrdersButton_clicked()
     loadAndDisplayOrders(); // Завантажуємо та відображаємо замовлення
 }
 
+namespace {
+QString orderDateText(const OrderDisplayInfo &orderInfo)
+{
+    // Використовуємо QLocale::ShortFormat і перевірку isValid()
+    return orderInfo.orderDate.isValid()
+           ? QLocale::system().toString(orderInfo.orderDate, QLocale::ShortFormat) // Дата і час відповідно до локалі
+           : QObject::tr("(невідома дата)");
+}
+
+// Текст та CSS-властивість статусу; true, якщо щось змінилося
+bool applyOrderStatus(QLabel *statusLabel, const OrderDisplayInfo &orderInfo)
+{
+    QString statusText = QObject::tr("Невідомо");
+    QString statusCss = "unknown"; // Статус для CSS (має бути lowercase)
+    if (!orderInfo.statuses.isEmpty()) {
+        // Беремо останній статус
+        statusText = orderInfo.statuses.last().status;
+        // TODO: Перетворити статус з БД на відповідний CSS-клас (new, processing, shipped, delivered, cancelled)
+        // Припускаємо, що вони співпадають після переведення в нижній регістр
+        statusCss = statusText.toLower();
+        // Приклад простого мапінгу (якщо назви відрізняються):
+        // if (statusText == "В обробці") statusCss = "processing";
+        // else if (statusText == "Відправлено") statusCss = "shipped";
+        // ... і т.д.
+    }
+    bool changed = KeyedWidgetList::setLabelText(statusLabel, statusText);
+    if (statusLabel->property("status").toString() != statusCss) {
+        statusLabel->setProperty("status", statusCss); // Встановлюємо властивість для CSS
+        changed = true;
+    }
+    return changed;
+}
+}
+
 // Метод для створення віджету картки замовлення (Новий дизайн)
 QWidget* MainWindow::createOrderWidget(const OrderDisplayInfo &orderInfo)
 {
@@ -42,11 +78,7 @@ QWidget* MainWindow::createOrderWidget(const OrderDisplayInfo &orderInfo)
     QLabel *idLabel = new QLabel(tr("Замовлення №%1").arg(orderInfo.orderId));
     idLabel->setObjectName("orderIdLabel"); // Ім'я для стилів
 
-    // Використовуємо QLocale::ShortFormat і перевірку isValid()
-    QString dateString = orderInfo.orderDate.isValid()
-                         ? QLocale::system().toString(orderInfo.orderDate, QLocale::ShortFormat) // Дата і час відповідно до локалі
-                         : tr("(невідома дата)");
-    QLabel *dateLabel = new QLabel(dateString);
+    QLabel *dateLabel = new QLabel(orderDateText(orderInfo));
     dateLabel->setObjectName("orderDateLabel"); // Ім'я для стилів
 
     infoLayout->addWidget(idLabel);
@@ -68,23 +100,7 @@ QWidget* MainWindow::createOrderWidget(const OrderDisplayInfo &orderInfo)
 
     QLabel *statusLabel = new QLabel();
     statusLabel->setObjectName("orderStatusLabel"); // Ім'я для стилів
-
-    // Визначаємо текст та CSS-властивість статусу
-    QString statusText = tr("Невідомо");
-    QString statusCss = "unknown"; // Статус для CSS (має бути lowercase)
-    if (!orderInfo.statuses.isEmpty()) {
-        // Беремо останній статус
-        statusText = orderInfo.statuses.last().status;
-        // TODO: Перетворити статус з БД на відповідний CSS-клас (new, processing, shipped, delivered, cancelled)
-        // Припускаємо, що вони співпадають після переведення в нижній регістр
-        statusCss = statusText.toLower();
-        // Приклад простого мапінгу (якщо назви відрізняються):
-        // if (statusText == "В обробці") statusCss = "processing";
-        // else if (statusText == "Відправлено") statusCss = "shipped";
-        // ... і т.д.
-    }
-    statusLabel->setText(statusText);
-    statusLabel->setProperty("status", statusCss); // Встановлюємо властивість для CSS
+    applyOrderStatus(statusLabel, orderInfo);
     statusLabel->ensurePolished(); // Застосовуємо стиль негайно
 
     // Кнопка "Деталі" (використовує стиль viewOrderDetailsButton з UI)
@@ -106,6 +122,20 @@ QWidget* MainWindow::createOrderWidget(const OrderDisplayInfo &orderInfo)
     return orderCard;
 }
 
+// Оновлює картку наявного замовлення: зазвичай змінюється лише статус
+void MainWindow::updateOrderWidget(QWidget *orderCard, const OrderDisplayInfo &orderInfo)
+{
+    KeyedWidgetList::setLabelText(orderCard->findChild<QLabel*>("orderDateLabel"), orderDateText(orderInfo));
+    KeyedWidgetList::setLabelText(orderCard->findChild<QLabel*>("orderTotalLabel"),
+                                  QString::number(orderInfo.totalAmount, 'f', 2) + tr(" грн"));
+    QLabel *statusLabel = orderCard->findChild<QLabel*>("orderStatusLabel");
+    if (statusLabel && applyOrderStatus(statusLabel, orderInfo)) {
+        // Селектор [status="..."] перераховується лише після повторного polish
+        statusLabel->style()->unpolish(statusLabel);
+        statusLabel->style()->polish(statusLabel);
+    }
+}
+
 // Метод для відображення списку замовлень (Новий дизайн)
 void MainWindow::displayOrders(const QList<OrderDisplayInfo> &orders)
 {
@@ -116,8 +146,14 @@ void MainWindow::displayOrders(const QList<OrderDisplayInfo> &orders)
         return;
     }
 
-    // Очищаємо layout від попередніх карток замовлень
-    clearLayout(ui->ordersContentLayout);
+    // Картки замовлень з тим самим orderId перевикористовуються, нові створюються, зниклі видаляються
+    KeyedWidgetList &orderCards = m_keyedWidgetLists[ui->ordersContentLayout];
+    const QList<QWidget*> cards = orderCards.reconcile(orders,
+        [](const OrderDisplayInfo &orderInfo) { return orderInfo.orderId; },
+        [this](const OrderDisplayInfo &orderInfo) { return createOrderWidget(orderInfo); },
+        [this](QWidget *orderCard, const OrderDisplayInfo &orderInfo) { updateOrderWidget(orderCard, orderInfo); });
+    qDebug() << "displayOrders: created" << orderCards.lastCreated() << "reused" << orderCards.lastReused() << "removed" << orderCards.lastRemoved();
+    KeyedWidgetList::placeInBoxLayout(ui->ordersContentLayout, cards);
 
     bool isEmpty = orders.isEmpty();
 
@@ -135,19 +171,6 @@ void MainWindow::displayOrders(const QList<OrderDisplayInfo> &orders)
          qWarning() << "displayOrders: ordersScrollArea is unexpectedly null right before setVisible()!";
     }
 
-
-    if (!isEmpty) {
-        // Додаємо картки для кожного замовлення
-        for (const OrderDisplayInfo &orderInfo : orders) {
-            QWidget *orderCard = createOrderWidget(orderInfo); // Використовуємо оновлену функцію
-            if (orderCard) {
-                ui->ordersContentLayout->addWidget(orderCard);
-            }
-        }
-        // Додаємо розтягувач, щоб притиснути картки вгору, якщо їх мало
-        ui->ordersContentLayout->addStretch(1);
-    }
- 
     // Оновлюємо геометрію контейнера, щоб ScrollArea знала розмір
     ui->ordersContainerWidget->adjustSize();
     // Переконуємось, що ScrollArea оновилась, якщо вміст змінився
@@ -172,66 +195,66 @@ void MainWindow::loadAndDisplayOrders()
         return;
     }
 
-    // Отримуємо всі замовлення
-    QList<OrderDisplayInfo> allOrders = m_dbManager->getCustomerOrdersForDisplay(m_currentCustomerId);
-    qInfo() << "Завантажено" << allOrders.size() << "замовлень.";
-
-    // // Отримуємо вибраний статус та дату для фільтрації - ВІДЖЕТИ ВИДАЛЕНО З UI
-    // QString statusFilter = ui->orderStatusComboBox->currentText();
-    // QDate dateFilter = ui->orderDateEdit->date(); // Отримуємо дату з QDateEdit
-    QList<OrderDisplayInfo> filteredOrders; // Список для відфільтрованих замовлень (зараз не використовується)
-
-    // Наразі фільтрація не застосовується, оскільки віджети видалено.
-    // Просто копіюємо всі замовлення до списку для відображення.
-    filteredOrders = allOrders;
-
-    /* // Старий код фільтрації (закоментовано)
-    for (const OrderDisplayInfo &order : allOrders) {
-        bool statusMatch = false;
-        bool dateMatch = false;
-
-        // Перевірка статусу
-        if (statusFilter == tr("Всі статуси")) {
-            statusMatch = true;
-        } else if (!order.statuses.isEmpty()) {
-            // Порівнюємо останній статус замовлення з вибраним фільтром
-            // Важливо: Переконайтесь, що рядки статусу з БД точно відповідають рядкам у ComboBox
-            if (order.statuses.last().status == statusFilter) {
+    // Отримуємо всі замовлення (у фоновому потоці)
+    m_dbManager->getCustomerOrdersForDisplayAsync(m_currentCustomerId, this, [this](const QList<OrderDisplayInfo> &allOrders) {
+        qInfo() << "Завантажено" << allOrders.size() << "замовлень.";
+
+        // // Отримуємо вибраний статус та дату для фільтрації - ВІДЖЕТИ ВИДАЛЕНО З UI
+        // QString statusFilter = ui->orderStatusComboBox->currentText();
+        // QDate dateFilter = ui->orderDateEdit->date(); // Отримуємо дату з QDateEdit
+        QList<OrderDisplayInfo> filteredOrders; // Список для відфільтрованих замовлень (зараз не використовується)
+
+        // Наразі фільтрація не застосовується, оскільки віджети видалено.
+        // Просто копіюємо всі замовлення до списку для відображення.
+        filteredOrders = allOrders;
+
+        /* // Старий код фільтрації (закоментовано)
+        for (const OrderDisplayInfo &order : allOrders) {
+            bool statusMatch = false;
+            bool dateMatch = false;
+
+            // Перевірка статусу
+            if (statusFilter == tr("Всі статуси")) {
                 statusMatch = true;
+            } else if (!order.statuses.isEmpty()) {
+                // Порівнюємо останній статус замовлення з вибраним фільтром
+                // Важливо: Переконайтесь, що рядки статусу з БД точно відповідають рядкам у ComboBox
+                if (order.statuses.last().status == statusFilter) {
+                    statusMatch = true;
+                }
             }
-        }
 
-        // Перевірка дати (замовлення має бути створене НЕ РАНІШЕ вибраної дати)
-        // Порівнюємо тільки дати, ігноруючи час
-        if (!dateFilter.isNull() && order.orderDate.isValid()) {
-             if (order.orderDate.date() >= dateFilter) {
+            // Перевірка дати (замовлення має бути створене НЕ РАНІШЕ вибраної дати)
+            // Порівнюємо тільки дати, ігноруючи час
+            if (!dateFilter.isNull() && order.orderDate.isValid()) {
+                 if (order.orderDate.date() >= dateFilter) {
+                     dateMatch = true;
+                 }
+            } else {
+                 // Якщо дата не вибрана (або дата замовлення невалідна), вважаємо, що дата підходить
                  dateMatch = true;
-             }
-        } else {
-             // Якщо дата не вибрана (або дата замовлення невалідна), вважаємо, що дата підходить
-             dateMatch = true;
-        }
+            }
 
 
-        // Додаємо замовлення, якщо воно відповідає обом фільтрам
-        if (statusMatch && dateMatch) {
-            filteredOrders.append(order);
+            // Додаємо замовлення, якщо воно відповідає обом фільтрам
+            if (statusMatch && dateMatch) {
+                filteredOrders.append(order);
+            }
         }
-    }
-    */
-    // qInfo() << "Відфільтровано" << filteredOrders.size() << "замовлень за статусом:" << statusFilter << "та датою від:" << dateFilter.toString(Qt::ISODate); // Закоментовано, бо фільтри не використовуються
+        */
+        // qInfo() << "Відфільтровано" << filteredOrders.size() << "замовлень за статусом:" << statusFilter << "та датою від:" << dateFilter.toString(Qt::ISODate); // Закоментовано, бо фільтри не використовуються
 
 
-    displayOrders(filteredOrders); // Відображаємо замовлення (наразі всі)
+        displayOrders(filteredOrders); // Відображаємо замовлення (наразі всі)
 
-    if (m_dbManager->lastError().isValid()) {
-         ui->statusBar->showMessage(tr("Помилка при завантаженні замовлень: %1").arg(m_dbManager->lastError().text()), 5000);
-    } else if (!filteredOrders.isEmpty()) { // Використовуємо відфільтрований список
-         ui->statusBar->showMessage(tr("Замовлення успішно завантажено."), 3000);
-    } else {
-         // Якщо помилки не було, але замовлень 0 (після фільтрації), показуємо відповідне повідомлення
-         ui->statusBar->showMessage(tr("У вас ще немає замовлень."), 3000);
-    }
+        // Помилки фонового запиту вже залоговано у потоці воркера (порожній список)
+        if (!filteredOrders.isEmpty()) { // Використовуємо відфільтрований список
+             ui->statusBar->showMessage(tr("Замовлення успішно завантажено."), 3000);
+        } else {
+             // Якщо помилки не було, але замовлень 0 (після фільтрації), показуємо відповідне повідомлення
+             ui->statusBar->showMessage(tr("У вас ще немає замовлень."), 3000);
+        }
+    });
 }
 
 // Видалено старий слот showOrderDetailsPlaceholder
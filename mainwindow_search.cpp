@@ -7,7 +7,13 @@
 #include <QDebug>
 #include <QListView>          // Додано для доступу до popup view
 #include "searchsuggestiondelegate.h" // Додано включення делегата
+#include "asyncimageloader.h"
 #include <QMessageBox>        // Додано для QMessageBox
+#include <algorithm>
+
+namespace {
+const int kSearchSuggestionLimit = 10;
+}
 
 // Налаштування автодоповнення для глобального пошуку
 void MainWindow::setupSearchCompleter()
@@ -49,6 +55,9 @@ void MainWindow::setupSearchCompleter()
             }
         )");
         // Логування стилю та палітри видалено
+        // Мініатюри пропозицій завантажуються у фоні — перемальовуємо popup після готовності
+        connect(AsyncImageLoader::instance(), &AsyncImageLoader::pixmapReady,
+                m_searchCompleter->popup()->viewport(), QOverload<>::of(&QWidget::update));
     } else {
         qWarning() << "setupSearchCompleter: Completer popup is null! Cannot set delegate.";
     }
@@ -64,10 +73,49 @@ void MainWindow::setupSearchCompleter()
             this, &MainWindow::onSearchSuggestionActivated);
 
 
+    m_searchDebounceTimer = new QTimer(this);
+    m_searchDebounceTimer->setSingleShot(true);
+    m_searchDebounceTimer->setInterval(250);
+    connect(m_searchDebounceTimer, &QTimer::timeout, this, &MainWindow::requestSearchSuggestions);
+
+    // Префіксний індекс завантажується один раз, далі періодично догружаються нові книги та автори
+    m_searchIndexRefreshTimer = new QTimer(this);
+    m_searchIndexRefreshTimer->setInterval(2 * 60 * 1000);
+    connect(m_searchIndexRefreshTimer, &QTimer::timeout, this, &MainWindow::refreshSearchIndex);
+    m_searchIndexRefreshTimer->start();
+    refreshSearchIndex();
+
+    m_dbManager->runAsync<bool>(this, [](DatabaseManager *db) {
+        return db->isFuzzySearchAvailable();
+    }, [this](bool available) {
+        m_fuzzySearchAvailable = available;
+        qInfo() << "Fuzzy search (pg_trgm) available:" << available;
+    });
+
     qInfo() << "Search completer setup complete for globalSearchLineEdit.";
 }
 
-// Слот для оновлення пропозицій пошуку при зміні тексту
+// Інкрементальне оновлення префіксного індексу: завантажуються лише записи з id,
+// більшими за вже відомі (перший виклик завантажує все)
+void MainWindow::refreshSearchIndex()
+{
+    if (!m_dbManager || m_searchIndexRefreshInFlight) {
+        return;
+    }
+    m_searchIndexRefreshInFlight = true;
+    m_dbManager->getSearchIndexEntriesAsync(m_searchIndex.maxBookId(), m_searchIndex.maxAuthorId(), this,
+                                            [this](const QList<SearchSuggestionInfo> &entries) {
+        m_searchIndexRefreshInFlight = false;
+        m_searchIndex.applyEntries(entries);
+        if (!m_searchIndex.isReady() && m_searchIndex.size() > 0) {
+            m_searchIndex.setReady(true);
+            qInfo() << "Search prefix index loaded:" << m_searchIndex.size() << "entries";
+        }
+    });
+}
+
+// Слот для оновлення пропозицій пошуку при зміні тексту.
+// Запит виконується не на кожну літеру, а після паузи в наборі (m_searchDebounceTimer)
 void MainWindow::updateSearchSuggestions(const QString &text)
 {
     if (!m_dbManager || !m_searchSuggestionModel) {
@@ -75,16 +123,79 @@ void MainWindow::updateSearchSuggestions(const QString &text)
         return; // Немає менеджера БД або моделі
     }
 
-    // Отримуємо пропозиції, якщо текст НЕ порожній (шукаємо з першої літери)
+    m_pendingSearchText = text;
+
+    // Порожній текст: очищаємо одразу і робимо недійсними всі запити в дорозі
     if (text.isEmpty()) {
+        m_searchDebounceTimer->stop();
+        m_searchGeneration->fetchAndAddRelaxed(1);
         m_searchSuggestionModel->clear(); // Очищаємо модель, якщо текст порожній
         m_searchCompleter->popup()->hide(); // Ховаємо popup
         return;
     }
 
-    // Отримуємо розширені пропозиції
-    QList<SearchSuggestionInfo> suggestions = m_dbManager->getSearchSuggestions(text);
+    // Локальний індекс відповідає миттєво — затримка не потрібна. Якщо збігів за
+    // префіксом замало, після паузи в наборі доповнюємо їх нечітким пошуком у БД
+    if (m_searchIndex.isReady()) {
+        m_searchGeneration->fetchAndAddRelaxed(1);
+        const QList<SearchSuggestionInfo> localSuggestions = m_searchIndex.suggestions(text, kSearchSuggestionLimit);
+        showSearchSuggestions(text, localSuggestions);
+        if (m_fuzzySearchAvailable && localSuggestions.size() < kSearchSuggestionLimit && text.trimmed().size() >= 3) {
+            m_searchDebounceTimer->start();
+        } else {
+            m_searchDebounceTimer->stop();
+        }
+        return;
+    }
 
+    m_searchDebounceTimer->start();
+}
+
+void MainWindow::requestSearchSuggestions()
+{
+    const QString text = m_pendingSearchText;
+    const int generation = m_searchGeneration->fetchAndAddRelaxed(1) + 1;
+    if (text.isEmpty()) {
+        return;
+    }
+
+    const DatabaseManager::SearchMode mode = m_fuzzySearchAvailable ? DatabaseManager::SearchMode::Fuzzy
+                                                                    : DatabaseManager::SearchMode::Prefix;
+    const QList<SearchSuggestionInfo> localSuggestions = m_searchIndex.isReady()
+            ? m_searchIndex.suggestions(text, kSearchSuggestionLimit)
+            : QList<SearchSuggestionInfo>();
+
+    QSharedPointer<QAtomicInt> latestGeneration = m_searchGeneration;
+    m_dbManager->runAsync<QList<SearchSuggestionInfo>>(this, [text, mode, generation, latestGeneration](DatabaseManager *db) {
+        // Поки запит чекав у черзі, користувач міг набрати далі — тоді не звертаємось до БД
+        if (latestGeneration->loadRelaxed() != generation) {
+            return QList<SearchSuggestionInfo>();
+        }
+        return db->getSearchSuggestions(text, kSearchSuggestionLimit, mode);
+    }, [this, text, generation, localSuggestions](const QList<SearchSuggestionInfo> &suggestions) {
+        if (m_searchGeneration->loadRelaxed() != generation) {
+            qInfo() << "Dropping stale search suggestions for text:" << text;
+            return;
+        }
+        // Збіги з локального індексу лишаються першими, результати БД додаються без дублікатів
+        QList<SearchSuggestionInfo> merged = localSuggestions;
+        for (const SearchSuggestionInfo &suggestion : suggestions) {
+            if (merged.size() >= kSearchSuggestionLimit) {
+                break;
+            }
+            const bool duplicate = std::any_of(merged.cbegin(), merged.cend(), [&suggestion](const SearchSuggestionInfo &existing) {
+                return existing.type == suggestion.type && existing.id == suggestion.id;
+            });
+            if (!duplicate) {
+                merged.append(suggestion);
+            }
+        }
+        showSearchSuggestions(text, merged);
+    });
+}
+
+void MainWindow::showSearchSuggestions(const QString &text, const QList<SearchSuggestionInfo> &suggestions)
+{
     // Очищаємо модель перед заповненням новими даними
     m_searchSuggestionModel->clear();
 
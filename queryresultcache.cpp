@@ -0,0 +1,100 @@
+#include "queryresultcache.h"
+#include <QDebug>
+
+QueryResultCache &QueryResultCache::instance()
+{
+    static QueryResultCache cache;
+    return cache;
+}
+
+QueryResultCache::QueryResultCache()
+{
+    m_clock.start();
+    m_entries.setMaxCost(20000); // Сумарна кількість рядків у кеші
+}
+
+QString QueryResultCache::key(const QString &queryName, const QVariantList &boundValues)
+{
+    QString result = queryName;
+    for (const QVariant &value : boundValues) {
+        result += QChar(0x1F) + value.toString();
+    }
+    return result;
+}
+
+quint64 QueryResultCache::generation() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+void QueryResultCache::insertLocked(const QString &key, const std::shared_ptr<const void> &value, const QStringList &tags, int ttlMs, int cost)
+{
+    removeEntryLocked(key);
+
+    Entry *entry = new Entry;
+    entry->value = value;
+    entry->tags = tags;
+    entry->expiresAtMs = m_clock.elapsed() + qMax(0, ttlMs);
+    // QCache сам видаляє найдавніше використані записи; індекс тегів чиститься ліниво
+    if (!m_entries.insert(key, entry, qMax(1, cost))) {
+        return; // Запис дорожчий за весь кеш — не кешуємо
+    }
+    for (const QString &tag : tags) {
+        m_keysByTag[tag].insert(key);
+    }
+}
+
+void QueryResultCache::removeEntryLocked(const QString &key)
+{
+    if (Entry *entry = m_entries.object(key)) {
+        for (const QString &tag : std::as_const(entry->tags)) {
+            auto it = m_keysByTag.find(tag);
+            if (it != m_keysByTag.end()) {
+                it->remove(key);
+            }
+        }
+        m_entries.remove(key);
+    }
+}
+
+void QueryResultCache::invalidateTag(const QString &tag)
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_generation;
+    const QSet<QString> keys = m_keysByTag.take(tag);
+    int removed = 0;
+    for (const QString &key : keys) {
+        if (m_entries.contains(key)) {
+            removeEntryLocked(key);
+            ++removed;
+        }
+    }
+    m_stats.invalidated += removed;
+    if (removed > 0) {
+        qDebug() << "QueryResultCache: invalidated" << removed << "entries for tag" << tag;
+    }
+}
+
+void QueryResultCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_generation;
+    m_entries.clear();
+    m_keysByTag.clear();
+}
+
+void QueryResultCache::setMaxCost(int maxCost)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.setMaxCost(qMax(1, maxCost));
+}
+
+QueryResultCache::Stats QueryResultCache::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    Stats result = m_stats;
+    result.entries = m_entries.count();
+    result.totalCost = m_entries.totalCost();
+    return result;
+}
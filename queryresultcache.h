@@ -0,0 +1,99 @@
+#ifndef QUERYRESULTCACHE_H
+#define QUERYRESULTCACHE_H
+
+#include <QCache>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <memory>
+
+// Кеш результатів запитів DatabaseManager (read-through), спільний для всіх потоків.
+// Ключ — ім'я запиту (-- name:) та значення параметрів. Кожен запис має TTL, вартість
+// (кількість рядків; загальний обсяг обмежено maxCost, витіснення — LRU) і теги таблиць,
+// від яких залежить результат: invalidateTag("book") скидає всі залежні записи.
+//
+// Використання в методі DatabaseManager:
+//     const QString key = QueryResultCache::key("GetAllDistinctGenres");
+//     if (QueryResultCache::instance().lookup(key, &genres)) return genres;
+//     const quint64 generation = QueryResultCache::instance().generation();
+//     ... запит до БД ...
+//     QueryResultCache::instance().insert(key, genres, {"book"}, ttlMs, genres.size(), generation);
+// generation захищає від гонки: якщо поки йшов запит щось інвалідовано, результат не кешується.
+class QueryResultCache
+{
+public:
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 expired = 0;
+        quint64 invalidated = 0;
+        int entries = 0;
+        int totalCost = 0;
+        double hitRate() const { return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+    };
+
+    static QueryResultCache &instance();
+    static QString key(const QString &queryName, const QVariantList &boundValues = QVariantList());
+
+    template <typename T>
+    bool lookup(const QString &key, T *value)
+    {
+        QMutexLocker locker(&m_mutex);
+        Entry *entry = m_entries.object(key);
+        if (!entry) {
+            ++m_stats.misses;
+            return false;
+        }
+        if (entry->expiresAtMs <= m_clock.elapsed()) {
+            removeEntryLocked(key);
+            ++m_stats.expired;
+            ++m_stats.misses;
+            return false;
+        }
+        ++m_stats.hits;
+        *value = *std::static_pointer_cast<const T>(entry->value);
+        return true;
+    }
+
+    template <typename T>
+    void insert(const QString &key, const T &value, const QStringList &tags, int ttlMs, int cost, quint64 generationAtLoad)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (generationAtLoad != m_generation) {
+            return; // Дані могли змінитися під час запиту
+        }
+        insertLocked(key, std::make_shared<const T>(value), tags, ttlMs, cost);
+    }
+
+    quint64 generation() const;
+    void invalidateTag(const QString &tag);
+    void clear();
+
+    void setMaxCost(int maxCost);
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const void> value;
+        QStringList tags;
+        qint64 expiresAtMs = 0;
+    };
+
+    QueryResultCache();
+    void insertLocked(const QString &key, const std::shared_ptr<const void> &value, const QStringList &tags, int ttlMs, int cost);
+    void removeEntryLocked(const QString &key);
+
+    mutable QMutex m_mutex;
+    QCache<QString, Entry> m_entries;
+    QHash<QString, QSet<QString>> m_keysByTag;
+    QElapsedTimer m_clock;
+    quint64 m_generation = 0;
+    Stats m_stats;
+};
+
+#endif // QUERYRESULTCACHE_H
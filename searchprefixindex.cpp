@@ -0,0 +1,112 @@
+#include "searchprefixindex.h"
+#include <algorithm>
+
+QString SearchPrefixIndex::foldKey(const QString &text)
+{
+    return text.trimmed().toCaseFolded();
+}
+
+quint64 SearchPrefixIndex::entryId(SearchSuggestionInfo::SuggestionType type, int id)
+{
+    return (static_cast<quint64>(type) << 32) | static_cast<quint32>(id);
+}
+
+bool SearchPrefixIndex::entryLess(const Entry &left, const Entry &right)
+{
+    if (left.key != right.key) {
+        return left.key < right.key;
+    }
+    // Стабільний порядок однакових назв: спершу книги, далі за id
+    if (left.info.type != right.info.type) {
+        return left.info.type < right.info.type;
+    }
+    return left.info.id < right.info.id;
+}
+
+QList<SearchSuggestionInfo> SearchPrefixIndex::suggestions(const QString &prefix, int limit) const
+{
+    QList<SearchSuggestionInfo> result;
+    const QString foldedPrefix = foldKey(prefix);
+    if (foldedPrefix.isEmpty()) {
+        return result;
+    }
+    const int maxCount = limit > 0 ? limit : 10;
+
+    auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), foldedPrefix,
+                               [](const Entry &entry, const QString &value) { return entry.key < value; });
+    for (; it != m_entries.cend() && result.size() < maxCount; ++it) {
+        if (!it->key.startsWith(foldedPrefix)) {
+            break;
+        }
+        result.append(it->info);
+    }
+    return result;
+}
+
+void SearchPrefixIndex::applyEntries(const QList<SearchSuggestionInfo> &entries)
+{
+    if (entries.isEmpty()) {
+        return;
+    }
+
+    // Записи, що вже є в індексі, видаляються і вставляються заново (назва могла змінитися)
+    QSet<quint64> replacedIds;
+    for (const SearchSuggestionInfo &info : entries) {
+        const quint64 id = entryId(info.type, info.id);
+        if (m_entryIds.contains(id)) {
+            replacedIds.insert(id);
+        }
+    }
+    if (!replacedIds.isEmpty()) {
+        m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&replacedIds](const Entry &entry) {
+            return replacedIds.contains(entryId(entry.info.type, entry.info.id));
+        }), m_entries.end());
+    }
+
+    // Нові записи сортуються окремо і зливаються з уже відсортованим масивом
+    const int oldSize = m_entries.size();
+    m_entries.reserve(oldSize + entries.size());
+    for (const SearchSuggestionInfo &info : entries) {
+        Entry entry;
+        entry.key = foldKey(info.displayText);
+        entry.info = info;
+        m_entryIds.insert(entryId(info.type, info.id));
+        if (info.type == SearchSuggestionInfo::Book) {
+            m_maxBookId = qMax(m_maxBookId, info.id);
+        } else {
+            m_maxAuthorId = qMax(m_maxAuthorId, info.id);
+        }
+        m_entries.append(entry);
+    }
+    std::sort(m_entries.begin() + oldSize, m_entries.end(), entryLess);
+    std::inplace_merge(m_entries.begin(), m_entries.begin() + oldSize, m_entries.end(), entryLess);
+}
+
+bool SearchPrefixIndex::updateEntry(const SearchSuggestionInfo &info)
+{
+    if (!m_entryIds.contains(entryId(info.type, info.id))) {
+        return false;
+    }
+    applyEntries({info});
+    return true;
+}
+
+void SearchPrefixIndex::removeEntry(SearchSuggestionInfo::SuggestionType type, int id)
+{
+    const quint64 key = entryId(type, id);
+    if (!m_entryIds.remove(key)) {
+        return;
+    }
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [key](const Entry &entry) {
+        return entryId(entry.info.type, entry.info.id) == key;
+    }), m_entries.end());
+}
+
+void SearchPrefixIndex::clear()
+{
+    m_entries.clear();
+    m_entryIds.clear();
+    m_maxBookId = 0;
+    m_maxAuthorId = 0;
+    m_ready = false;
+}
@@ -0,0 +1,56 @@
+#ifndef SEARCHPREFIXINDEX_H
+#define SEARCHPREFIXINDEX_H
+
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include "datatypes.h"
+
+// Клієнтський префіксний індекс для підказок пошуку.
+// Назви книг та імена авторів зберігаються у відсортованому масиві за ключем у
+// case-folded формі, тож пошук за префіксом — це бінарний пошук (lower_bound) і
+// послідовний прохід до першого ключа, що вже не починається з префікса.
+// Працює лише в GUI-потоці; дані завантажуються асинхронно і додаються через applyEntries().
+class SearchPrefixIndex
+{
+public:
+    SearchPrefixIndex() = default;
+
+    // Ті самі правила, що й у GetSearchSuggestions: збіг з початком назви/імені, сортування за текстом
+    QList<SearchSuggestionInfo> suggestions(const QString &prefix, int limit = 10) const;
+
+    // Додає нові або замінює наявні (за типом та id) записи
+    void applyEntries(const QList<SearchSuggestionInfo> &entries);
+    // Замінює лише вже завантажений запис (перейменування); false — запису ще немає в індексі,
+    // його додасть інкрементальне оновлення (maxBookId/maxAuthorId не зсуваються)
+    bool updateEntry(const SearchSuggestionInfo &info);
+    void removeEntry(SearchSuggestionInfo::SuggestionType type, int id);
+    void clear();
+
+    bool isReady() const { return m_ready; }
+    void setReady(bool ready) { m_ready = ready; }
+    int size() const { return m_entries.size(); }
+    // Найбільші відомі id — з них починається інкрементальне оновлення
+    int maxBookId() const { return m_maxBookId; }
+    int maxAuthorId() const { return m_maxAuthorId; }
+
+    static QString foldKey(const QString &text);
+
+private:
+    struct Entry {
+        QString key; // Текст у case-folded формі
+        SearchSuggestionInfo info;
+    };
+
+    static quint64 entryId(SearchSuggestionInfo::SuggestionType type, int id);
+    static bool entryLess(const Entry &left, const Entry &right);
+
+    QVector<Entry> m_entries; // Відсортовано за key
+    QSet<quint64> m_entryIds; // (тип, id) записів в індексі, для заміни
+    int m_maxBookId = 0;
+    int m_maxAuthorId = 0;
+    bool m_ready = false;
+};
+
+#endif // SEARCHPREFIXINDEX_H
@@ -1,4 +1,5 @@
 #include "searchsuggestiondelegate.h"
+#include "asyncimageloader.h"
 
 SearchSuggestionDelegate::SearchSuggestionDelegate(QObject *parent)
     : QStyledItemDelegate(parent)
@@ -19,11 +20,13 @@ void SearchSuggestionDelegate::paint(QPainter *painter, const QStyleOptionViewIt
                     m_imageSize,
                     m_imageSize);
 
-    QPixmap pixmap(imagePath);
+    // Зменшене зображення береться з кешу; якщо його там немає, воно декодується у фоні,
+    // а до того малюється сіра заглушка
+    QPixmap pixmap;
+    AsyncImageLoader::instance()->requestPixmap(imagePath, imageRect.size(), Qt::KeepAspectRatio, &pixmap);
     if (pixmap.isNull()) {
         painter->fillRect(imageRect, Qt::lightGray);
     } else {
-        pixmap = pixmap.scaled(imageRect.size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
         painter->drawPixmap(imageRect.left() + (m_imageSize - pixmap.width()) / 2,
                            imageRect.top() + (m_imageSize - pixmap.height()) / 2,
                            pixmap);
@@ -7,16 +7,15 @@ SELECT
     b.stock_quantity,
     b.genre,
     COALESCE(p.name, 'Невідомий видавець') AS publisher_name,
-    STRING_AGG(DISTINCT a.first_name || ' ' || a.last_name, ', ') AS authors
+    b.authors_text AS authors,
+    b.rating_sum,
+    b.rating_count
 FROM book b
 LEFT JOIN publisher p ON b.publisher_id = p.publisher_id
-LEFT JOIN book_author ba ON b.book_id = ba.book_id
-LEFT JOIN author a ON ba.author_id = a.author_id
-GROUP BY b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre, p.name
 ORDER BY b.title;
 
 -- name: GetFilteredBooksForDisplayBase
-SELECT DISTINCT -- Використовуємо DISTINCT, оскільки JOIN з авторами може дублювати книги
+SELECT
     b.book_id,
     b.title,
     b.price,
@@ -25,13 +24,24 @@ SELECT DISTINCT -- Використовуємо DISTINCT, оскільки JOIN
     b.genre,
     b.language, -- Додано мову
     COALESCE(p.name, 'Невідомий видавець') AS publisher_name,
-    STRING_AGG(DISTINCT a.first_name || ' ' || a.last_name, ', ') AS authors
+    b.authors_text AS authors,
+    b.rating_sum,
+    b.rating_count
 FROM book b
 LEFT JOIN publisher p ON b.publisher_id = p.publisher_id
-LEFT JOIN book_author ba ON b.book_id = ba.book_id
-LEFT JOIN author a ON ba.author_id = a.author_id
 -- WHERE clause will be added dynamically in C++ code
--- GROUP BY and ORDER BY will be added dynamically in C++ code
+-- ORDER BY will be added dynamically in C++ code
+
+-- name: GetBooksPageBase
+-- Keyset-пагінація за (title, book_id) або (rating_avg DESC, book_id); умови фільтра та курсора
+-- підставляються замість %1, порядок сортування — замість %2 у C++ коді.
+-- Автори беруться з денормалізованого book.authors_text (підтримується тригерами).
+SELECT b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre, b.language,
+b.authors_text AS authors, b.rating_sum, b.rating_count, b.rating_avg
+FROM book b
+%1
+ORDER BY %2
+LIMIT :pageLimit;
 
 -- name: GetAllDistinctGenres
 SELECT DISTINCT genre FROM book WHERE genre IS NOT NULL AND genre != '' ORDER BY genre;
@@ -44,13 +54,10 @@ SELECT
     b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity,
     b.genre, b.description, b.publication_date, b.isbn, b.page_count, b.language,
     COALESCE(p.name, 'Невідомий видавець') AS publisher_name,
-    STRING_AGG(DISTINCT a.first_name || ' ' || a.last_name, ', ') AS authors
+    b.authors_text AS authors
 FROM book b
 LEFT JOIN publisher p ON b.publisher_id = p.publisher_id
-LEFT JOIN book_author ba ON b.book_id = ba.book_id
-LEFT JOIN author a ON ba.author_id = a.author_id
 WHERE b.book_id = :bookId
-GROUP BY b.book_id, p.name, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre, b.description, b.publication_date, b.isbn, b.page_count, b.language
 LIMIT 1;
 
 -- name: GetBookDisplayInfoById
@@ -61,12 +68,11 @@ SELECT
     b.cover_image_path,
     b.stock_quantity,
     b.genre,
-    STRING_AGG(DISTINCT a.first_name || ' ' || a.last_name, ', ') AS authors
+    b.authors_text AS authors,
+    b.rating_sum,
+    b.rating_count
 FROM book b
-LEFT JOIN book_author ba ON b.book_id = ba.book_id
-LEFT JOIN author a ON ba.author_id = a.author_id
 WHERE b.book_id = :bookId
-GROUP BY b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre
 LIMIT 1;
 
 -- name: GetBooksByGenre
@@ -78,13 +84,12 @@ SELECT
     b.stock_quantity,
     b.genre,
     COALESCE(p.name, 'Невідомий видавець') AS publisher_name,
-    STRING_AGG(DISTINCT a.first_name || ' ' || a.last_name, ', ') AS authors
+    b.authors_text AS authors,
+    b.rating_sum,
+    b.rating_count
 FROM book b
 LEFT JOIN publisher p ON b.publisher_id = p.publisher_id
-LEFT JOIN book_author ba ON b.book_id = ba.book_id
-LEFT JOIN author a ON ba.author_id = a.author_id
 WHERE b.genre = :genre
-GROUP BY b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre, p.name
 ORDER BY b.publication_date DESC, b.title
 LIMIT :limit;
 
@@ -99,19 +104,118 @@ WHERE LOWER(first_name || ' ' || last_name) LIKE LOWER(:prefix) || '%'
 ORDER BY display_text
 LIMIT :total_limit;
 
+-- name: GetFuzzySearchSuggestions
+-- Пошук підрядка та нечіткий збіг (pg_trgm, GIN-індекси idx_*_trgm); спершу збіги з початком, далі за схожістю
+SELECT type, id, display_text, image_path, price
+FROM (
+    SELECT 'book' AS type, book_id AS id, title AS display_text, cover_image_path AS image_path, price,
+           word_similarity(LOWER(:query), LOWER(title)) AS score,
+           LOWER(title) LIKE LOWER(:query) || '%' AS is_prefix
+    FROM book
+    WHERE LOWER(title) LIKE '%' || LOWER(:query) || '%'
+       OR LOWER(:query) <% LOWER(title)
+    UNION ALL
+    SELECT 'author' AS type, author_id AS id, first_name || ' ' || last_name AS display_text, image_path, 0.0 AS price,
+           word_similarity(LOWER(:query), LOWER(first_name || ' ' || last_name)) AS score,
+           LOWER(first_name || ' ' || last_name) LIKE LOWER(:query) || '%' AS is_prefix
+    FROM author
+    WHERE LOWER(first_name || ' ' || last_name) LIKE '%' || LOWER(:query) || '%'
+       OR LOWER(:query) <% LOWER(first_name || ' ' || last_name)
+) matches
+ORDER BY is_prefix DESC, score DESC, display_text
+LIMIT :total_limit;
+
+-- name: CheckFuzzySearchAvailable
+SELECT EXISTS (SELECT 1 FROM pg_extension WHERE extname = 'pg_trgm') AS available;
+
+-- name: GetSearchIndexEntries
+-- Дані для клієнтського префіксного індексу; :afterBookId/:afterAuthorId дають інкрементальне оновлення
+SELECT 'book' AS type, book_id AS id, title AS display_text, cover_image_path AS image_path, price
+FROM book
+WHERE book_id > :afterBookId
+UNION ALL
+SELECT 'author' AS type, author_id AS id, first_name || ' ' || last_name AS display_text, image_path, 0.0 AS price
+FROM author
+WHERE author_id > :afterAuthorId;
+
 -- name: GetSimilarBooksByGenre
-SELECT
-    b.book_id,
-    b.title,
-    b.price,
-    b.cover_image_path,
-    b.stock_quantity,
-    b.genre,
-    STRING_AGG(DISTINCT a.first_name || ' ' || a.last_name, ', ') AS authors
-FROM book b
-LEFT JOIN book_author ba ON b.book_id = ba.book_id
-LEFT JOIN author a ON ba.author_id = a.author_id
-WHERE b.genre = :genre AND b.book_id != :currentBookId
-GROUP BY b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre
-ORDER BY RANDOM()
+-- Випадкова вибірка без сортування всього жанру: випадкова точка між MIN і MAX book_id жанру
+-- (обидва беруться з індексу (genre, book_id)), далі :limit книг від неї за індексом,
+-- а якщо до кінця жанру їх менше — решта з початку (wrap-around).
+WITH bounds AS (
+    SELECT MIN(book_id) AS min_id, MAX(book_id) AS max_id
+    FROM book
+    WHERE genre = :genre
+), pivot AS (
+    SELECT min_id + CAST(FLOOR(random() * (max_id - min_id + 1)) AS INTEGER) AS pivot_id
+    FROM bounds
+)
+SELECT book_id, title, price, cover_image_path, stock_quantity, genre, authors, rating_sum, rating_count
+FROM (
+    (SELECT b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre,
+            b.authors_text AS authors, b.rating_sum, b.rating_count
+     FROM book b, pivot
+     WHERE b.genre = :genre AND b.book_id != :currentBookId AND b.book_id >= pivot.pivot_id
+     ORDER BY b.book_id
+     LIMIT :limit)
+    UNION ALL
+    (SELECT b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre,
+            b.authors_text AS authors, b.rating_sum, b.rating_count
+     FROM book b, pivot
+     WHERE b.genre = :genre AND b.book_id != :currentBookId AND b.book_id < pivot.pivot_id
+     ORDER BY b.book_id
+     LIMIT :limit)
+) sample
 LIMIT :limit;
+
+-- name: GetSimilarBooksFromSimilarity
+-- Готові рекомендації з book_similarity: один прохід індексом (book_id, score DESC)
+SELECT b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre,
+       b.authors_text AS authors, b.rating_sum, b.rating_count
+FROM book_similarity s
+JOIN book b ON b.book_id = s.similar_book_id
+WHERE s.book_id = :bookId
+ORDER BY s.score DESC, s.similar_book_id
+LIMIT :limit;
+
+-- name: TryLockBookSimilarityRebuild
+-- Перерахунок запускає кожен клієнт; одночасно його виконує лише один (блокування до кінця транзакції)
+SELECT pg_try_advisory_xact_lock(hashtext('book_similarity_rebuild')) AS acquired;
+
+-- name: DeleteBookSimilarity
+DELETE FROM book_similarity;
+
+-- name: RebuildBookSimilarity
+-- Схожість за спільними покупками: together / sqrt(orders_a * orders_b) (косинус над множинами замовлень),
+-- для кожної книги зберігається :topK найближчих сусідів
+WITH book_orders AS (
+    SELECT DISTINCT order_id, book_id FROM order_item
+), order_counts AS (
+    SELECT book_id, COUNT(*) AS order_count FROM book_orders GROUP BY book_id
+), pairs AS (
+    SELECT a.book_id, b.book_id AS similar_book_id, COUNT(*) AS together
+    FROM book_orders a
+    JOIN book_orders b ON b.order_id = a.order_id AND b.book_id != a.book_id
+    GROUP BY a.book_id, b.book_id
+), scored AS (
+    SELECT p.book_id, p.similar_book_id,
+           p.together / SQRT(CAST(ca.order_count AS DOUBLE PRECISION) * cb.order_count) AS score
+    FROM pairs p
+    JOIN order_counts ca ON ca.book_id = p.book_id
+    JOIN order_counts cb ON cb.book_id = p.similar_book_id
+), ranked AS (
+    SELECT book_id, similar_book_id, score,
+           ROW_NUMBER() OVER (PARTITION BY book_id ORDER BY score DESC, similar_book_id) AS rn
+    FROM scored
+)
+INSERT INTO book_similarity (book_id, similar_book_id, score)
+SELECT book_id, similar_book_id, score
+FROM ranked
+WHERE rn <= :topK;
+
+-- name: GetCatalogSnapshot
+-- Легкі колонки всього каталогу для CatalogSnapshot (локальна фільтрація); порядок — як у сортуванні за назвою
+SELECT b.book_id, b.title, b.price, b.cover_image_path, b.stock_quantity, b.genre, b.language,
+       b.authors_text AS authors, b.rating_sum, b.rating_count, b.rating_avg
+FROM book b
+ORDER BY b.title, b.book_id;
@@ -13,3 +13,18 @@ DELETE FROM cart_item WHERE customer_id = :customerId AND book_id = :bookId;
 
 -- name: ClearCartByCustomerId
 DELETE FROM cart_item WHERE customer_id = :customerId;
+
+-- name: ApplyCartChanges
+-- Пакетний запис накопичених змін кошика (журнал MainWindow): одним запитом видаляються
+-- позиції з :removedBookIds та вставляються/оновлюються пари (:bookIds, :quantities)
+WITH removed AS (
+    DELETE FROM cart_item
+    WHERE customer_id = CAST(:customerId AS INTEGER)
+      AND book_id = ANY(CAST(:removedBookIds AS INTEGER[]))
+)
+INSERT INTO cart_item (customer_id, book_id, quantity, added_date)
+SELECT CAST(:customerId AS INTEGER), u.book_id, u.quantity, CURRENT_TIMESTAMP
+FROM unnest(CAST(:bookIds AS INTEGER[]), CAST(:quantities AS INTEGER[])) AS u(book_id, quantity)
+ON CONFLICT (customer_id, book_id) DO UPDATE SET
+    quantity = EXCLUDED.quantity,
+    added_date = CURRENT_TIMESTAMP;
@@ -9,6 +9,7 @@ VALUES (:book_id, :customer_id, :comment_text, CURRENT_TIMESTAMP, :rating);
 
 -- name: GetBookCommentsByBookId
 SELECT
+    c.comment_id,
     c.comment_text,
     c.comment_date,
     c.rating,
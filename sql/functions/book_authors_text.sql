@@ -0,0 +1,70 @@
+-- Денормалізований список авторів книги (book.authors_text).
+-- Замість STRING_AGG з подвійним JOIN у кожному запиті каталогу список авторів
+-- перераховується лише при зміні book_author або імені автора.
+
+-- name: CreateRefreshBookAuthorsTextFunction
+-- Description: Перераховує authors_text для вказаних книг (NULL — для всіх книг).
+CREATE OR REPLACE FUNCTION refresh_book_authors_text(book_ids_param INT[])
+RETURNS VOID AS $$
+BEGIN
+    UPDATE book b
+    SET authors_text = COALESCE((
+        SELECT STRING_AGG(DISTINCT a.first_name || ' ' || a.last_name, ', ')
+        FROM book_author ba
+        JOIN author a ON ba.author_id = a.author_id
+        WHERE ba.book_id = b.book_id
+    ), '')
+    WHERE book_ids_param IS NULL OR b.book_id = ANY(book_ids_param);
+END;
+$$ LANGUAGE plpgsql;
+
+-- name: CreateBookAuthorAuthorsTextTriggerFunction
+CREATE OR REPLACE FUNCTION book_author_refresh_authors_text()
+RETURNS TRIGGER AS $$
+BEGIN
+    IF TG_OP = 'DELETE' THEN
+        PERFORM refresh_book_authors_text(ARRAY[OLD.book_id]);
+        RETURN OLD;
+    END IF;
+    IF TG_OP = 'UPDATE' AND OLD.book_id <> NEW.book_id THEN
+        PERFORM refresh_book_authors_text(ARRAY[OLD.book_id, NEW.book_id]);
+    ELSE
+        PERFORM refresh_book_authors_text(ARRAY[NEW.book_id]);
+    END IF;
+    RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+-- name: DropBookAuthorAuthorsTextTrigger
+DROP TRIGGER IF EXISTS trg_book_author_authors_text ON book_author;
+
+-- name: CreateBookAuthorAuthorsTextTrigger
+CREATE TRIGGER trg_book_author_authors_text
+AFTER INSERT OR UPDATE OR DELETE ON book_author
+FOR EACH ROW
+EXECUTE FUNCTION book_author_refresh_authors_text();
+
+-- name: CreateAuthorAuthorsTextTriggerFunction
+CREATE OR REPLACE FUNCTION author_refresh_authors_text()
+RETURNS TRIGGER AS $$
+BEGIN
+    PERFORM refresh_book_authors_text(ARRAY(
+        SELECT ba.book_id FROM book_author ba WHERE ba.author_id = NEW.author_id
+    ));
+    RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Видалення автора каскадно видаляє рядки book_author, тож його обробляє тригер book_author
+-- name: DropAuthorAuthorsTextTrigger
+DROP TRIGGER IF EXISTS trg_author_authors_text ON author;
+
+-- name: CreateAuthorAuthorsTextTrigger
+CREATE TRIGGER trg_author_authors_text
+AFTER UPDATE OF first_name, last_name ON author
+FOR EACH ROW
+WHEN (OLD.first_name IS DISTINCT FROM NEW.first_name OR OLD.last_name IS DISTINCT FROM NEW.last_name)
+EXECUTE FUNCTION author_refresh_authors_text();
+
+-- name: RefreshAllBookAuthorsText
+SELECT refresh_book_authors_text(NULL);
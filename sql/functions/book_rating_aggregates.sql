@@ -0,0 +1,40 @@
+-- Денормалізовані агрегати оцінок книги (book.rating_sum / rating_count, rating_avg — обчислювана колонка).
+-- Оцінка 0 (NULL) означає коментар без оцінки і в агрегатах не враховується.
+
+-- name: CreateCommentRatingTriggerFunction
+CREATE OR REPLACE FUNCTION comment_update_book_rating()
+RETURNS TRIGGER AS $$
+BEGIN
+    IF TG_OP IN ('UPDATE', 'DELETE') AND COALESCE(OLD.rating, 0) > 0 THEN
+        UPDATE book
+        SET rating_sum = rating_sum - OLD.rating, rating_count = rating_count - 1
+        WHERE book_id = OLD.book_id;
+    END IF;
+    IF TG_OP IN ('INSERT', 'UPDATE') AND COALESCE(NEW.rating, 0) > 0 THEN
+        UPDATE book
+        SET rating_sum = rating_sum + NEW.rating, rating_count = rating_count + 1
+        WHERE book_id = NEW.book_id;
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+-- name: DropCommentRatingTrigger
+DROP TRIGGER IF EXISTS trg_comment_book_rating ON comment;
+
+-- name: CreateCommentRatingTrigger
+CREATE TRIGGER trg_comment_book_rating
+AFTER INSERT OR DELETE OR UPDATE OF rating, book_id ON comment
+FOR EACH ROW
+EXECUTE FUNCTION comment_update_book_rating();
+
+-- name: RefreshAllBookRatings
+UPDATE book b
+SET rating_sum = r.rating_sum, rating_count = r.rating_count
+FROM (
+    SELECT bk.book_id, COALESCE(SUM(c.rating), 0) AS rating_sum, COUNT(c.rating) AS rating_count
+    FROM book bk
+    LEFT JOIN comment c ON c.book_id = bk.book_id AND c.rating > 0
+    GROUP BY bk.book_id
+) r
+WHERE b.book_id = r.book_id;
@@ -1,15 +1,16 @@
--- Name: CreateCalculateAverageRatingFunction
--- Description: Creates or replaces a function to calculate the average rating for a given book_id, ignoring ratings of 0.
+-- name: CreateCalculateAverageRatingFunction
+-- Description: Returns the average rating for a given book_id from the denormalized book.rating_sum/rating_count (ratings of 0 are not counted).
 CREATE OR REPLACE FUNCTION calculate_average_book_rating(book_id_param INT)
 RETURNS NUMERIC AS $$
 DECLARE
     avg_rating NUMERIC;
 BEGIN
-    SELECT COALESCE(AVG(rating), 0.0) -- Return 0.0 if no ratings > 0 exist
+    -- Агрегати підтримуються тригером trg_comment_book_rating, тому без сканування comment
+    SELECT CASE WHEN rating_count > 0 THEN CAST(rating_sum AS NUMERIC) / rating_count ELSE 0.0 END
     INTO avg_rating
-    FROM comment
-    WHERE book_id = book_id_param AND rating > 0; -- Only consider ratings greater than 0
+    FROM book
+    WHERE book_id = book_id_param;
 
-    RETURN avg_rating;
+    RETURN COALESCE(avg_rating, 0.0);
 END;
 $$ LANGUAGE plpgsql;
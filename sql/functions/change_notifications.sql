@@ -0,0 +1,76 @@
+-- Сповіщення клієнтів про зміни (LISTEN bookstore_changes, див. DatabaseManager::startChangeNotifications).
+-- Корисне навантаження — JSON: {"table": ..., "op": "INSERT|UPDATE|DELETE", "backend_pid": ..., <ключові колонки з аргументів тригера>}.
+-- backend_pid — серверний процес, що зробив зміну: клієнт впізнає власні записи з усіх своїх з'єднань.
+-- Для book передаються всі колонки знімка каталогу, щоб клієнти оновлювали рядок на місці (CatalogSnapshot::updateBook).
+-- Однакові сповіщення в межах транзакції PostgreSQL доставляє один раз, після коміту.
+
+-- name: CreateNotifyBookstoreChangeFunction
+CREATE OR REPLACE FUNCTION notify_bookstore_change()
+RETURNS TRIGGER AS $$
+DECLARE
+    row_data JSONB;
+    payload JSONB;
+    i INTEGER;
+BEGIN
+    IF TG_OP = 'DELETE' THEN
+        row_data := to_jsonb(OLD);
+    ELSE
+        row_data := to_jsonb(NEW);
+    END IF;
+    payload := jsonb_build_object('table', TG_TABLE_NAME, 'op', TG_OP, 'backend_pid', pg_backend_pid());
+    FOR i IN 0 .. TG_NARGS - 1 LOOP
+        payload := payload || jsonb_build_object(TG_ARGV[i], row_data -> TG_ARGV[i]);
+    END LOOP;
+    PERFORM pg_notify('bookstore_changes', payload::text);
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+-- name: DropBookNotifyTrigger
+DROP TRIGGER IF EXISTS trg_book_notify_change ON book;
+
+-- name: CreateBookNotifyTrigger
+CREATE TRIGGER trg_book_notify_change
+AFTER INSERT OR DELETE OR UPDATE OF title, price, stock_quantity, genre, language, cover_image_path, authors_text, rating_sum, rating_count ON book
+FOR EACH ROW
+EXECUTE FUNCTION notify_bookstore_change('book_id', 'title', 'price', 'stock_quantity', 'genre', 'language',
+                                         'cover_image_path', 'authors_text', 'rating_sum', 'rating_count', 'rating_avg');
+
+-- Список авторів кешується з тегом "author" (QueryResultCache), імена — у префіксному індексі
+-- підказок (SearchPrefixIndex); зміни book_author доходять
+-- до клієнтів через book.authors_text і тригер book
+-- name: DropAuthorNotifyTrigger
+DROP TRIGGER IF EXISTS trg_author_notify_change ON author;
+
+-- name: CreateAuthorNotifyTrigger
+CREATE TRIGGER trg_author_notify_change
+AFTER INSERT OR DELETE OR UPDATE ON author
+FOR EACH ROW
+EXECUTE FUNCTION notify_bookstore_change('author_id', 'first_name', 'last_name', 'image_path');
+
+-- name: DropCommentNotifyTrigger
+DROP TRIGGER IF EXISTS trg_comment_notify_change ON comment;
+
+-- name: CreateCommentNotifyTrigger
+CREATE TRIGGER trg_comment_notify_change
+AFTER INSERT OR DELETE OR UPDATE ON comment
+FOR EACH ROW
+EXECUTE FUNCTION notify_bookstore_change('comment_id', 'book_id');
+
+-- name: DropOrderStatusNotifyTrigger
+DROP TRIGGER IF EXISTS trg_order_status_notify_change ON order_status;
+
+-- name: CreateOrderStatusNotifyTrigger
+CREATE TRIGGER trg_order_status_notify_change
+AFTER INSERT OR DELETE OR UPDATE ON order_status
+FOR EACH ROW
+EXECUTE FUNCTION notify_bookstore_change('order_id', 'status');
+
+-- name: DropCartItemNotifyTrigger
+DROP TRIGGER IF EXISTS trg_cart_item_notify_change ON cart_item;
+
+-- name: CreateCartItemNotifyTrigger
+CREATE TRIGGER trg_cart_item_notify_change
+AFTER INSERT OR DELETE OR UPDATE ON cart_item
+FOR EACH ROW
+EXECUTE FUNCTION notify_bookstore_change('customer_id', 'book_id', 'quantity');
@@ -0,0 +1,44 @@
+-- Керований набір вторинних індексів.
+-- Усі запити з цього файлу виконуються в createSchemaTables (у порядку оголошення)
+-- і перевіряються при запуску (DatabaseManager::verifyIndexes): відсутні індекси створюються.
+-- Кожен запит має бути ідемпотентним (IF NOT EXISTS) і створювати рівно один індекс.
+
+-- Каталог: keyset-пагінація за (title, book_id)
+-- name: CreateBookTitleIdIndex
+CREATE INDEX IF NOT EXISTS idx_book_title_book_id ON book (title, book_id);
+
+-- Каталог: фільтри за жанром, мовою та ціною
+-- (genre, book_id) також обслуговує вибірку схожих книг (GetSimilarBooksByGenre)
+-- name: CreateBookGenreIndex
+CREATE INDEX IF NOT EXISTS idx_book_genre_book_id ON book (genre, book_id);
+
+-- name: CreateBookLanguageIndex
+CREATE INDEX IF NOT EXISTS idx_book_language ON book (language);
+
+-- name: CreateBookPriceIndex
+CREATE INDEX IF NOT EXISTS idx_book_price ON book (price);
+
+-- Сторінка книги: коментарі, новіші першими
+-- name: CreateCommentBookIdIndex
+CREATE INDEX IF NOT EXISTS idx_comment_book_id ON comment (book_id, comment_date DESC);
+
+-- Замовлення: список замовлень покупця, позиції та історія статусів
+-- name: CreateOrderCustomerIdIndex
+CREATE INDEX IF NOT EXISTS idx_order_customer_id ON "order" (customer_id, order_date DESC);
+
+-- name: CreateOrderItemOrderIdIndex
+CREATE INDEX IF NOT EXISTS idx_order_item_order_id ON order_item (order_id);
+
+-- name: CreateOrderStatusOrderIdIndex
+CREATE INDEX IF NOT EXISTS idx_order_status_order_id ON order_status (order_id, status_date);
+
+-- Сторінка автора: книги автора (первинний ключ book_author починається з book_id)
+-- name: CreateBookAuthorAuthorIdIndex
+CREATE INDEX IF NOT EXISTS idx_book_author_author_id ON book_author (author_id);
+
+-- Каталог: сортування за середньою оцінкою (keyset за (rating_avg DESC, book_id))
+-- name: CreateBookRatingIndex
+CREATE INDEX IF NOT EXISTS idx_book_rating_avg_book_id ON book (rating_avg DESC, book_id);
+
+-- name: CreateBookSimilarityScoreIndex
+CREATE INDEX IF NOT EXISTS idx_book_similarity_book_score ON book_similarity (book_id, score DESC);
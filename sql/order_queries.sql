@@ -15,27 +15,77 @@ FROM order_status
 WHERE order_id = :orderId
 ORDER BY status_date ASC;
 
--- name: InsertOrderHeader
-INSERT INTO "order" (customer_id, order_date, total_amount, shipping_address, payment_method)
-VALUES (:customer_id, CURRENT_TIMESTAMP, 0.0, :shipping_address, :payment_method)
-RETURNING order_id;
-
--- name: GetBookPriceAndStockForUpdate
-SELECT price, stock_quantity FROM book WHERE book_id = :book_id FOR UPDATE;
-
--- name: UpdateBookStock
-UPDATE book SET stock_quantity = stock_quantity - :quantity WHERE book_id = :book_id AND stock_quantity >= :quantity;
+-- name: GetOrderItemsByOrderIds
+SELECT oi.order_id, oi.quantity, oi.price_per_unit, b.title
+FROM order_item oi
+JOIN book b ON oi.book_id = b.book_id
+WHERE oi.order_id = ANY(CAST(:orderIds AS INTEGER[]))
+ORDER BY oi.order_id, oi.order_item_id;
 
--- name: InsertOrderItem
-INSERT INTO order_item (order_id, book_id, quantity, price_per_unit)
-VALUES (:order_id, :book_id, :quantity, :price_per_unit);
+-- name: GetOrderStatusesByOrderIds
+SELECT order_id, status, status_date, tracking_number
+FROM order_status
+WHERE order_id = ANY(CAST(:orderIds AS INTEGER[]))
+ORDER BY order_id, status_date ASC;
 
--- name: UpdateOrderTotalAmount
-UPDATE "order" SET total_amount = :total WHERE order_id = :order_id;
+-- name: LockBooksForOrder
+-- Блокування рядків книг кошика у фіксованому порядку (book_id) перед PlaceOrder
+SELECT book_id
+FROM book
+WHERE book_id = ANY(CAST(:bookIds AS INTEGER[]))
+ORDER BY book_id
+FOR UPDATE;
 
--- name: InsertOrderStatus
-INSERT INTO order_status (order_id, status, status_date)
-VALUES (:order_id, :status, CURRENT_TIMESTAMP);
+-- name: PlaceOrder
+-- Оформлення замовлення одним запитом: списання залишків, заголовок, позиції, сума, початковий статус,
+-- бонусні бали (1 бал за кожні 10 грн суми) та видалення оформлених позицій з кошика.
+-- Заголовок вставляється лише якщо списано всі позиції; інакше C++ код відкочує транзакцію
+-- (requested_count != updated_count, order_id = NULL).
+WITH requested AS (
+    SELECT r.book_id, r.quantity
+    FROM unnest(CAST(:bookIds AS INTEGER[]), CAST(:quantities AS INTEGER[])) AS r(book_id, quantity)
+), updated AS (
+    UPDATE book b
+    SET stock_quantity = b.stock_quantity - r.quantity
+    FROM requested r
+    WHERE b.book_id = r.book_id AND b.stock_quantity >= r.quantity
+    RETURNING b.book_id, b.price, r.quantity
+), summary AS (
+    SELECT (SELECT COUNT(*) FROM requested) AS requested_count,
+           COUNT(*) AS updated_count,
+           COALESCE(SUM(price * quantity), 0) AS total
+    FROM updated
+), new_order AS (
+    INSERT INTO "order" (customer_id, order_date, total_amount, shipping_address, payment_method)
+    SELECT CAST(:customerId AS INTEGER), CURRENT_TIMESTAMP, s.total, CAST(:shippingAddress AS TEXT), CAST(:paymentMethod AS VARCHAR(50))
+    FROM summary s
+    WHERE s.updated_count > 0 AND s.updated_count = s.requested_count
+    RETURNING order_id, total_amount
+), new_items AS (
+    INSERT INTO order_item (order_id, book_id, quantity, price_per_unit)
+    SELECT o.order_id, u.book_id, u.quantity, u.price
+    FROM new_order o CROSS JOIN updated u
+), new_status AS (
+    INSERT INTO order_status (order_id, status, status_date)
+    SELECT order_id, CAST(:status AS VARCHAR(50)), CURRENT_TIMESTAMP
+    FROM new_order
+), awarded AS (
+    UPDATE customer c
+    SET loyalty_points = c.loyalty_points + CAST(FLOOR(o.total_amount / 10) AS INTEGER),
+        loyalty_program = TRUE -- Вмикаємо програму лояльності при нарахуванні балів
+    FROM new_order o
+    WHERE c.customer_id = CAST(:customerId AS INTEGER) AND FLOOR(o.total_amount / 10) > 0
+    RETURNING CAST(FLOOR(o.total_amount / 10) AS INTEGER) AS points
+), cleared AS (
+    DELETE FROM cart_item ci
+    USING new_order o
+    WHERE ci.customer_id = CAST(:customerId AS INTEGER)
+      AND ci.book_id = ANY(CAST(:bookIds AS INTEGER[]))
+)
+SELECT s.requested_count, s.updated_count, o.order_id, o.total_amount,
+       COALESCE((SELECT points FROM awarded), 0) AS loyalty_points_awarded
+FROM summary s
+LEFT JOIN new_order o ON TRUE;
 
 -- name: GetCustomerOrderHeadersByCustomerId
 SELECT order_id, order_date::text, total_amount, shipping_address, payment_method
@@ -1,3 +1,6 @@
+-- name: DropBookSimilarityTable
+DROP TABLE IF EXISTS book_similarity CASCADE;
+
 -- name: DropOrderStatusTable
 DROP TABLE IF EXISTS order_status CASCADE;
 
@@ -56,6 +59,10 @@ CREATE TABLE book (
     page_count INTEGER CHECK (page_count > 0),
     cover_image_path VARCHAR(512),
     genre VARCHAR(100),
+    authors_text TEXT NOT NULL DEFAULT '', -- Автори через кому, підтримується тригерами book_author/author
+    rating_sum INTEGER NOT NULL DEFAULT 0, -- Сума оцінок 1-5 з comment, підтримується тригером
+    rating_count INTEGER NOT NULL DEFAULT 0, -- Кількість оцінок 1-5
+    rating_avg NUMERIC(3, 2) GENERATED ALWAYS AS (CASE WHEN rating_count > 0 THEN ROUND(CAST(rating_sum AS NUMERIC) / rating_count, 2) ELSE 0 END) STORED,
     CONSTRAINT fk_publisher FOREIGN KEY (publisher_id) REFERENCES publisher(publisher_id) ON DELETE SET NULL
 );
 
@@ -112,3 +119,75 @@ CREATE TABLE cart_item (
     CONSTRAINT fk_customer_cart FOREIGN KEY (customer_id) REFERENCES customer(customer_id) ON DELETE CASCADE,
     CONSTRAINT fk_book_cart FOREIGN KEY (book_id) REFERENCES book(book_id) ON DELETE CASCADE
 );
+
+-- Top-K сусідів кожної книги за спільними покупками; перераховується пакетно (RebuildBookSimilarity)
+-- name: CreateBookSimilarityTable
+CREATE TABLE IF NOT EXISTS book_similarity (
+    book_id INTEGER NOT NULL,
+    similar_book_id INTEGER NOT NULL,
+    score DOUBLE PRECISION NOT NULL, -- Косинусна схожість за замовленнями, 0..1
+    PRIMARY KEY (book_id, similar_book_id),
+    CONSTRAINT fk_book_similarity_book FOREIGN KEY (book_id) REFERENCES book(book_id) ON DELETE CASCADE,
+    CONSTRAINT fk_book_similarity_similar FOREIGN KEY (similar_book_id) REFERENCES book(book_id) ON DELETE CASCADE
+);
+
+-- Розширення та індекси для нечіткого пошуку підказок (див. GetFuzzySearchSuggestions).
+-- Створюються окремо від основної транзакції: без прав на CREATE EXTENSION схема все одно працює.
+-- name: CreatePgTrgmExtension
+CREATE EXTENSION IF NOT EXISTS pg_trgm;
+
+-- name: CreateBookTitleTrgmIndex
+CREATE INDEX IF NOT EXISTS idx_book_title_trgm ON book USING GIN (LOWER(title) gin_trgm_ops);
+
+-- name: CreateAuthorNameTrgmIndex
+CREATE INDEX IF NOT EXISTS idx_author_name_trgm ON author USING GIN (LOWER(first_name || ' ' || last_name) gin_trgm_ops);
+
+-- Перевірка керованих індексів (sql/indexes.sql) при запуску
+-- name: GetExistingIndexNames
+SELECT indexname FROM pg_indexes
+WHERE schemaname = current_schema()
+AND indexname = ANY(CAST(:indexNames AS TEXT[]));
+
+-- Оновлення схеми вже існуючої БД (DatabaseManager::upgradeSchema)
+-- name: CheckColumnExists
+SELECT EXISTS (
+SELECT 1 FROM information_schema.columns
+WHERE table_schema = current_schema() AND table_name = :tableName AND column_name = :columnName
+) AS column_exists;
+
+-- Чи містить тіло функції фрагмент (оновлення CREATE OR REPLACE FUNCTION без зміни тригерів)
+-- name: CheckFunctionSourceContains
+SELECT EXISTS (
+SELECT 1 FROM pg_proc p
+JOIN pg_namespace n ON n.oid = p.pronamespace
+WHERE n.nspname = current_schema() AND p.proname = :functionName
+AND position(CAST(:fragment AS TEXT) IN p.prosrc) > 0
+) AS source_contains;
+
+-- name: CheckIndexExists
+SELECT EXISTS (
+SELECT 1 FROM pg_indexes
+WHERE schemaname = current_schema() AND indexname = :indexName
+) AS index_exists;
+
+-- idx_book_genre (genre) замінено на idx_book_genre_book_id (genre, book_id) з sql/indexes.sql
+-- name: DropLegacyBookGenreIndex
+DROP INDEX IF EXISTS idx_book_genre;
+
+-- name: AddBookAuthorsTextColumn
+ALTER TABLE book ADD COLUMN IF NOT EXISTS authors_text TEXT NOT NULL DEFAULT '';
+
+-- name: AddBookRatingColumns
+ALTER TABLE book
+ADD COLUMN IF NOT EXISTS rating_sum INTEGER NOT NULL DEFAULT 0,
+ADD COLUMN IF NOT EXISTS rating_count INTEGER NOT NULL DEFAULT 0,
+ADD COLUMN IF NOT EXISTS rating_avg NUMERIC(3, 2) GENERATED ALWAYS AS (CASE WHEN rating_count > 0 THEN ROUND(CAST(rating_sum AS NUMERIC) / rating_count, 2) ELSE 0 END) STORED;
+
+-- Чи передає тригер колонку в сповіщенні (аргументи tgargs розділені нульовими байтами)
+-- name: CheckTriggerHasArgument
+SELECT EXISTS (
+SELECT 1 FROM pg_trigger t
+JOIN pg_class c ON c.oid = t.tgrelid
+WHERE c.relname = :tableName AND t.tgname = :triggerName AND NOT t.tgisinternal
+AND position(CAST(:argument AS TEXT) IN encode(t.tgargs, 'escape')) > 0
+) AS has_argument;